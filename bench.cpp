@@ -0,0 +1,1210 @@
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Benchmark da r_json. Os documentos são gerados localmente, sempre com a
+ * mesma semente, para que execuções diferentes possam ser comparadas. O
+ * resultado é impresso em json na saída padrão.
+ * Uso: r_json_bench [escala], onde escala multiplica o tamanho dos documentos. */
+
+#include "r_json.h"
+#include "r_json_plus.hpp"
+#include "r_json_pool.hpp"
+#include "r_json_arena.hpp"
+#include "bench_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* A parte do gzip depende da zlib (veja BENCH_GZIP no Makefile). */
+#ifdef RJS_BENCH_GZIP
+#include "r_json_gzip.hpp"
+
+#include <zlib.h>
+#endif
+
+namespace {
+	/* Gerador congruencial linear, determinístico em qualquer plataforma. */
+	class Random {
+		private:
+			unsigned long long state;
+
+		public:
+			Random(unsigned long long seed) : state(seed) {}
+
+			unsigned int next(void){
+				state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+				return (unsigned int) (state >> 33);
+			}
+
+			unsigned int range(unsigned int max){
+				return next() % max;
+			}
+
+			double real(double min, double max){
+				return min + (max - min) * (next() / 2147483648.0);
+			}
+	};
+
+	struct Corpus {
+		std::string name;
+		/* Documentos a serem lidos. Apenas o ndjson tem mais de um. */
+		std::vector<std::string> documents;
+		rjs_size_t bytes;
+	};
+
+	struct ParseResult {
+		double mb_per_s;
+		double arena_per_byte;
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	/* Evita que o compilador descarte os resultados das buscas. */
+	double checksum = 0.0;
+
+	void append_number(std::string &out, double number){
+		char buffer[64];
+
+		std::snprintf(buffer, sizeof(buffer), "%.6f", number);
+		out += buffer;
+	}
+
+	void append_integer(std::string &out, unsigned long number){
+		char buffer[64];
+
+		std::snprintf(buffer, sizeof(buffer), "%lu", number);
+		out += buffer;
+	}
+
+	void append_word(std::string &out, Random &random, unsigned int length){
+		static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+
+		for(unsigned int i = 0; i < length; i++)
+			out += letters[random.range(26)];
+	}
+
+	Corpus make_corpus(const char *name){
+		Corpus corpus;
+
+		corpus.name = name;
+		corpus.bytes = 0;
+
+		return corpus;
+	}
+
+	void finish_corpus(Corpus &corpus){
+		for(std::size_t i = 0; i < corpus.documents.size(); i++)
+			corpus.bytes += corpus.documents[i].size();
+	}
+
+	/* Documento parecido com a resposta da API do twitter: objetos médios,
+	 * muitas strings curtas e chaves repetidas. */
+	Corpus generate_twitter(unsigned int scale){
+		Corpus corpus = make_corpus("twitter");
+		Random random(1);
+		std::string out = "{\"statuses\":[";
+
+		for(unsigned int i = 0; i < 2000 * scale; i++){
+			if(i != 0) out += ',';
+
+			out += "{\"id\":";
+			append_integer(out, 500000000UL + random.next());
+			out += ",\"text\":\"";
+			for(unsigned int w = 0; w < 12; w++){
+				append_word(out, random, 1 + random.range(8));
+				out += ' ';
+			}
+			out += "\",\"user\":{\"name\":\"";
+			append_word(out, random, 10);
+			out += "\",\"screen_name\":\"";
+			append_word(out, random, 8);
+			out += "\",\"followers_count\":";
+			append_integer(out, random.range(100000));
+			out += ",\"verified\":";
+			out += random.range(10) == 0 ? "true" : "false";
+			out += "},\"retweet_count\":";
+			append_integer(out, random.range(1000));
+			out += ",\"favorited\":false,\"in_reply_to\":null,\"entities\":{\"hashtags\":[";
+			for(unsigned int h = 0, n = random.range(4); h < n; h++){
+				if(h != 0) out += ',';
+				out += '\"';
+				append_word(out, random, 6);
+				out += '\"';
+			}
+			out += "]}}";
+		}
+
+		out += "]}";
+		corpus.documents.push_back(out);
+		finish_corpus(corpus);
+
+		return corpus;
+	}
+
+	/* Documento parecido com o canada.json: quase só arrays de coordenadas. */
+	Corpus generate_canada(unsigned int scale){
+		Corpus corpus = make_corpus("canada");
+		Random random(2);
+		std::string out = "{\"type\":\"FeatureCollection\",\"features\":[";
+
+		for(unsigned int f = 0; f < 20 * scale; f++){
+			if(f != 0) out += ',';
+
+			out += "{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+			for(unsigned int r = 0; r < 4; r++){
+				if(r != 0) out += ',';
+				out += '[';
+				for(unsigned int p = 0; p < 500; p++){
+					if(p != 0) out += ',';
+					out += '[';
+					append_number(out, random.real(-140.0, -50.0));
+					out += ',';
+					append_number(out, random.real(40.0, 80.0));
+					out += ']';
+				}
+				out += ']';
+			}
+			out += "]}}";
+		}
+
+		out += "]}";
+		corpus.documents.push_back(out);
+		finish_corpus(corpus);
+
+		return corpus;
+	}
+
+	void generate_deep_object(std::string &out, Random &random, unsigned int depth){
+		out += "{\"id\":";
+		append_integer(out, random.next());
+		out += ",\"name\":\"";
+		append_word(out, random, 12);
+		out += "\",\"subjectCode\":null,\"topicIds\":[";
+		append_integer(out, random.range(1000));
+		out += ',';
+		append_integer(out, random.range(1000));
+		out += ']';
+
+		if(depth != 0){
+			out += ",\"children\":[";
+			for(unsigned int i = 0; i < 2; i++){
+				if(i != 0) out += ',';
+				generate_deep_object(out, random, depth - 1);
+			}
+			out += ']';
+		}
+
+		out += '}';
+	}
+
+	/* Documento parecido com o citm_catalog.json: objetos aninhados com
+	 * muitos níveis de profundidade. */
+	Corpus generate_citm(unsigned int scale){
+		Corpus corpus = make_corpus("citm");
+		Random random(3);
+		std::string out = "{\"events\":{";
+
+		for(unsigned int i = 0; i < 8 * scale; i++){
+			if(i != 0) out += ',';
+
+			out += "\"";
+			append_integer(out, 138586341UL + i);
+			out += "\":";
+			generate_deep_object(out, random, 9);
+		}
+
+		out += "}}";
+		corpus.documents.push_back(out);
+		finish_corpus(corpus);
+
+		return corpus;
+	}
+
+	/* Logs em ndjson: muitos documentos pequenos, um por linha. */
+	Corpus generate_ndjson(unsigned int scale){
+		static const char *levels[] = {"debug", "info", "warn", "error"};
+		Corpus corpus = make_corpus("ndjson");
+		Random random(4);
+
+		for(unsigned int i = 0; i < 20000 * scale; i++){
+			std::string out = "{\"ts\":";
+
+			append_integer(out, 1700000000UL + i);
+			out += ",\"level\":\"";
+			out += levels[random.range(4)];
+			out += "\",\"service\":\"";
+			append_word(out, random, 6);
+			out += "\",\"latency\":";
+			append_integer(out, random.range(2000));
+			out += ",\"msg\":\"";
+			append_word(out, random, 24);
+			out += "\"}";
+
+			corpus.documents.push_back(out);
+		}
+
+		finish_corpus(corpus);
+
+		return corpus;
+	}
+
+	/* Strings longas com caracteres de controle. As strings ficam abaixo de
+	 * RJS_MAX_STRING_SIZE para não serem truncadas. */
+	Corpus generate_strings(unsigned int scale){
+		Corpus corpus = make_corpus("strings");
+		Random random(5);
+		std::string out = "{\"docs\":[";
+
+		for(unsigned int i = 0; i < 4000 * scale; i++){
+			if(i != 0) out += ',';
+
+			out += "{\"id\":";
+			append_integer(out, i);
+			out += ",\"body\":\"";
+			for(unsigned int w = 0; w < 24; w++){
+				append_word(out, random, 8);
+				out += random.range(8) == 0 ? "\\n" : " ";
+			}
+			out += "\"}";
+		}
+
+		out += "]}";
+		corpus.documents.push_back(out);
+		finish_corpus(corpus);
+
+		return corpus;
+	}
+
+	double seconds_since(Clock::time_point start){
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	/* Lê o corpus algumas vezes e retorna a melhor velocidade. */
+	ParseResult bench_parse(const Corpus &corpus, std::vector<char> &arena, int flags){
+		ParseResult result = {0.0, 0.0};
+		rjs_parser_t parser;
+		rjs_size_t arena_bytes = 0;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+		rjs_set_flags(&parser, flags);
+
+		for(int run = 0; run < 5; run++){
+			Clock::time_point start = Clock::now();
+			double seconds;
+
+			for(std::size_t i = 0; i < corpus.documents.size(); i++){
+				if(!rjs_parse_string(&parser, corpus.documents[i].c_str())){
+					std::fprintf(stderr, "%s: %s\n", corpus.name.c_str(), rjs_get_error(&parser));
+					std::exit(1);
+				}
+
+				if(run == 0)
+					arena_bytes += parser.memory.top + (parser.memory.size - parser.memory.string_top);
+			}
+
+			seconds = seconds_since(start);
+
+			if(corpus.bytes / seconds / 1e6 > result.mb_per_s)
+				result.mb_per_s = corpus.bytes / seconds / 1e6;
+		}
+
+		result.arena_per_byte = (double) arena_bytes / corpus.bytes;
+
+		return result;
+	}
+
+	/* Mede o tempo médio, em nanosegundos, de cada busca feita por lookup. */
+	template <typename F>
+	double bench_lookup(rjs_size_t lookups, F lookup){
+		double best = 0.0;
+
+		for(int run = 0; run < 5; run++){
+			Clock::time_point start = Clock::now();
+			double ns;
+
+			lookup();
+			ns = seconds_since(start) * 1e9 / lookups;
+
+			if(run == 0 || ns < best)
+				best = ns;
+		}
+
+		return best;
+	}
+
+#ifdef RJS_BENCH_GZIP
+	/* Compacta o texto no formato gzip. */
+	std::string gzip_compress(const std::string &text){
+		std::string out(compressBound((uLong) text.size()) + 32, '\0');
+		z_stream stream;
+
+		stream.zalloc = Z_NULL;
+		stream.zfree = Z_NULL;
+		stream.opaque = Z_NULL;
+
+		/* 15 + 16: janela máxima, com cabeçalho gzip. */
+		deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		stream.next_in = (Bytef *) text.data();
+		stream.avail_in = (uInt) text.size();
+		stream.next_out = (Bytef *) &out[0];
+		stream.avail_out = (uInt) out.size();
+		deflate(&stream, Z_FINISH);
+		out.resize(stream.total_out);
+		deflateEnd(&stream);
+
+		return out;
+	}
+
+	/* Descompacta todo o texto compactado em out, que já tem o tamanho do
+	 * texto. */
+	void gzip_decompress(const std::string &compressed, std::string &out){
+		z_stream stream;
+
+		stream.zalloc = Z_NULL;
+		stream.zfree = Z_NULL;
+		stream.opaque = Z_NULL;
+
+		inflateInit2(&stream, 15 + 32);
+		stream.next_in = (Bytef *) compressed.data();
+		stream.avail_in = (uInt) compressed.size();
+		stream.next_out = (Bytef *) &out[0];
+		stream.avail_out = (uInt) out.size();
+		inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+	}
+
+	/* Lê todos os eventos com o leitor, pedindo os pedaços a next. */
+	void read_events(char *buffer, rjs_size_t size, const std::function<void(const char **, std::size_t *)> &next){
+		rjs_reader_t reader;
+		rjs_event_t event;
+		int status;
+
+		rjs_reader_create(&reader, buffer, size);
+
+		while((status = rjs_reader_next(&reader, &event)) != RJS_READER_DONE){
+			if(status == RJS_READER_NEED_INPUT){
+				const char *chunk;
+				std::size_t length;
+
+				next(&chunk, &length);
+				rjs_reader_feed(&reader, chunk, length);
+			}
+			else if(status == RJS_READER_EVENT){
+				checksum += event.type;
+			}
+			else{
+				break;
+			}
+		}
+	}
+#endif
+
+	/* Percorre o documento inteiro, somando os números. */
+	double walk(rjs::Object object){
+		double sum = 0.0;
+
+		if(object.size() == 0)
+			return sum;
+
+		for(rjs::Key key = object[0]; key.isValid(); key.next()){
+			if(key.getType() == RJS_KEY_NUMBER)
+				sum += key.get<double>();
+			else if(key.getType() == RJS_KEY_OBJECT)
+				sum += walk(key.get<rjs::Object>());
+		}
+
+		return sum;
+	}
+
+	/* Escreve em paths o caminho de todas as chaves do objeto, no formato de
+	 * rjs_get_path. */
+	void collect_paths(const rjs_object_t *object, const std::string &prefix, std::vector<std::string> &paths){
+		rjs_size_t position = 0;
+
+		for(const rjs_key_t *key = object->start_key; key != NULL; key = key->next, position++){
+			std::string path = prefix + '/';
+
+			if(object->is_array){
+				path += std::to_string(position);
+			}
+			else{
+				for(const char *c = key->name; *c != '\0'; c++){
+					if(*c == '~') path += "~0";
+					else if(*c == '/') path += "~1";
+					else path += *c;
+				}
+			}
+
+			paths.push_back(path);
+
+			if(key->value.type == RJS_KEY_OBJECT)
+				collect_paths(key->value.data.obj, path, paths);
+		}
+	}
+
+	/* Soma os números do documento com Object::walk. */
+	struct NumberSum {
+		double sum;
+
+		void operator()(const char *, double number){
+			sum += number;
+		}
+
+		template <typename T>
+		void operator()(const char *, T){
+		}
+	};
+
+	void print_parse(const char *name, rjs_size_t bytes, ParseResult result, bool last){
+		std::printf("\t\t{\"name\": \"%s\", \"bytes\": %lu, \"parse_mb_s\": %.2f, \"arena_bytes_per_input_byte\": %.3f}%s\n",
+				name, bytes, result.mb_per_s, result.arena_per_byte, last ? "" : ",");
+	}
+};
+
+int main(int argc, char **argv){
+	unsigned int scale = argc > 1 ? (unsigned int) std::atoi(argv[1]) : 1;
+	std::vector<Corpus> corpora;
+	std::vector<char> arena;
+	rjs_size_t largest = 0;
+
+	if(scale == 0)
+		scale = 1;
+
+	corpora.push_back(generate_twitter(scale));
+	corpora.push_back(generate_canada(scale));
+	corpora.push_back(generate_citm(scale));
+	corpora.push_back(generate_ndjson(scale));
+	corpora.push_back(generate_strings(scale));
+
+	for(std::size_t i = 0; i < corpora.size(); i++){
+		for(std::size_t j = 0; j < corpora[i].documents.size(); j++){
+			if(corpora[i].documents[j].size() > largest)
+				largest = corpora[i].documents[j].size();
+		}
+	}
+
+	arena.resize(largest * 16 + (1 << 20));
+
+	std::printf("{\n\t\"scale\": %u,\n\t\"parse\": [\n", scale);
+
+	for(std::size_t i = 0; i < corpora.size(); i++)
+		print_parse(corpora[i].name.c_str(), corpora[i].bytes, bench_parse(corpora[i], arena, 0), false);
+
+	print_parse("canada_packed", corpora[1].bytes, bench_parse(corpora[1], arena, RJS_FLAG_PACK_NUMBERS), false);
+	/* Números que apontam para o texto lido e são convertidos só quando lidos. */
+	print_parse("twitter_lazy", corpora[0].bytes, bench_parse(corpora[0], arena, RJS_FLAG_LAZY_NUMBERS), false);
+	print_parse("canada_lazy", corpora[1].bytes, bench_parse(corpora[1], arena, RJS_FLAG_LAZY_NUMBERS), true);
+
+	std::printf("\t],\n");
+
+	/* Buscas feitas sobre o documento do twitter. */
+	{
+		const Corpus &twitter = corpora[0];
+		rjs_parser_t parser;
+		std::vector<const rjs_object_t *> statuses;
+		const rjs_object_t *status_array;
+		const rjs_key_t *key;
+		rjs_size_t lookups;
+		double c_key, c_index, cpp_key, single_keys, multi_keys, wide_single, wide_multi;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+		rjs_parse_string(&parser, twitter.documents[0].c_str());
+
+		status_array = rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "statuses"));
+
+		for(key = status_array->start_key; key != NULL; key = key->next)
+			statuses.push_back(rjs_get_vobj(key));
+
+		lookups = statuses.size() * 3;
+
+		c_key = bench_lookup(lookups, [&](){
+			for(std::size_t i = 0; i < statuses.size(); i++){
+				checksum += rjs_get_vnumber(rjs_get_key(statuses[i], "id"));
+				checksum += rjs_get_vnumber(rjs_get_key(statuses[i], "retweet_count"));
+				checksum += rjs_get_vbool(rjs_get_key(statuses[i], "favorited"));
+			}
+		});
+
+		/* Todas as chaves de cada status, uma a uma e com rjs_get_keys. */
+		{
+			static const char * const names[] = {"id", "text", "user", "retweet_count", "favorited", "in_reply_to", "entities"};
+
+			single_keys = bench_lookup(statuses.size() * 7, [&](){
+				for(std::size_t i = 0; i < statuses.size(); i++){
+					for(int k = 0; k < 7; k++)
+						checksum += rjs_get_key(statuses[i], names[k])->value.type;
+				}
+			});
+
+			multi_keys = bench_lookup(statuses.size() * 7, [&](){
+				const rjs_key_t *keys[7];
+
+				for(std::size_t i = 0; i < statuses.size(); i++){
+					rjs_get_keys(statuses[i], names, 7, keys);
+
+					for(int k = 0; k < 7; k++)
+						checksum += keys[k]->value.type;
+				}
+			});
+		}
+
+		/* 20 das 40 chaves de objetos largos, fora de ordem: o caso em que
+		 * percorrer a lista uma vez só compensa. */
+		{
+			std::vector<std::string> wide_names;
+			std::vector<const char *> names;
+			std::vector<const rjs_object_t *> objects;
+			std::vector<char> wide_arena(1 << 24);
+			std::string text = "{\"rows\": [";
+			rjs_parser_t wide_parser;
+			Random random(9);
+
+			for(int k = 0; k < 40; k++){
+				std::string name;
+
+				append_word(name, random, 4 + random.range(8));
+				name += '_';
+				append_integer(name, k);
+				wide_names.push_back(name);
+			}
+
+			for(int i = 0; i < 1000; i++){
+				text += i == 0 ? "{" : ", {";
+
+				for(int k = 0; k < 40; k++){
+					text += k == 0 ? "\"" : ", \"";
+					text += wide_names[k] + "\": ";
+					append_integer(text, random.range(100000));
+				}
+
+				text += "}";
+			}
+
+			text += "]}";
+
+			for(int k = 0; k < 20; k++)
+				names.push_back(wide_names[(k * 7 + 3) % 40].c_str());
+
+			rjs_create_parser(&wide_parser, wide_arena.data(), wide_arena.size());
+			rjs_parse_string(&wide_parser, text.c_str());
+
+			for(key = rjs_get_vobj(rjs_get_key(rjs_get_main_object(&wide_parser), "rows"))->start_key; key != NULL; key = key->next)
+				objects.push_back(rjs_get_vobj(key));
+
+			wide_single = bench_lookup(objects.size() * 20, [&](){
+				for(std::size_t i = 0; i < objects.size(); i++){
+					for(int k = 0; k < 20; k++)
+						checksum += rjs_get_key(objects[i], names[k])->value.type;
+				}
+			});
+
+			wide_multi = bench_lookup(objects.size() * 20, [&](){
+				const rjs_key_t *keys[20];
+
+				for(std::size_t i = 0; i < objects.size(); i++){
+					rjs_get_keys(objects[i], names.data(), 20, keys);
+
+					for(int k = 0; k < 20; k++)
+						checksum += keys[k]->value.type;
+				}
+			});
+		}
+
+		/* Busca por índice em uma array de tamanho médio. */
+		c_index = bench_lookup(1000, [&](){
+			Random random(6);
+
+			for(int i = 0; i < 1000; i++){
+				const rjs_key_t *status = rjs_get_key_index(status_array, random.range(1000));
+				checksum += rjs_get_length(rjs_get_vobj(status));
+			}
+		});
+
+		/* O mesmo acesso do rjs_get_key, mas pelo wrapper de C++. */
+		rjs::Parser cpp_parser(arena.data(), arena.size());
+		cpp_parser.parse(twitter.documents[0].c_str());
+		rjs::Object cpp_statuses = cpp_parser.getMainObject()["statuses"].get<rjs::Object>();
+		std::vector<rjs::Object> cpp_objects;
+
+		for(rjs::Key status = cpp_statuses[0]; status.isValid(); status.next())
+			cpp_objects.push_back(status.get<rjs::Object>());
+
+		cpp_key = bench_lookup(lookups, [&](){
+			for(std::size_t i = 0; i < cpp_objects.size(); i++){
+				checksum += cpp_objects[i]["id"].get<double>();
+				checksum += cpp_objects[i]["retweet_count"].get<double>();
+				checksum += cpp_objects[i]["favorited"].get<bool>();
+			}
+		});
+
+		std::printf("\t\"lookup\": {\n");
+		std::printf("\t\t\"rjs_get_key_ns\": %.2f,\n", c_key);
+		std::printf("\t\t\"all_keys_rjs_get_key_ns\": %.2f,\n", single_keys);
+		std::printf("\t\t\"all_keys_rjs_get_keys_ns\": %.2f,\n", multi_keys);
+		std::printf("\t\t\"wide_20_of_40_rjs_get_key_ns\": %.2f,\n", wide_single);
+		std::printf("\t\t\"wide_20_of_40_rjs_get_keys_ns\": %.2f,\n", wide_multi);
+		std::printf("\t\t\"rjs_get_key_index_ns\": %.2f,\n", c_index);
+		std::printf("\t\t\"cpp_key_ns\": %.2f,\n", cpp_key);
+		std::printf("\t\t\"cpp_overhead_ratio\": %.3f\n", cpp_key / c_key);
+		std::printf("\t},\n");
+	}
+
+	/* Leitura do ndjson em paralelo, com cada vez mais threads. */
+	{
+		const Corpus &ndjson = corpora[3];
+		std::vector<const char *> docs;
+		unsigned max_threads = std::thread::hardware_concurrency();
+		rjs::Pool pool(1, 1 << 16);
+
+		if(max_threads < 4)
+			max_threads = 4;
+
+		for(std::size_t i = 0; i < ndjson.documents.size(); i++)
+			docs.push_back(ndjson.documents[i].c_str());
+
+		std::unique_ptr<bool[]> results(new bool[docs.size()]);
+
+		std::printf("\t\"batch\": [\n");
+
+		for(unsigned threads = 1; threads <= max_threads; threads *= 2){
+			double best = 0.0;
+
+			for(int run = 0; run < 5; run++){
+				Clock::time_point start = Clock::now();
+				double mb_per_s;
+
+				rjs::parse_batch(pool, docs.data(), docs.size(), results.get(), threads);
+				mb_per_s = ndjson.bytes / seconds_since(start) / 1e6;
+
+				if(mb_per_s > best)
+					best = mb_per_s;
+			}
+
+			std::printf("\t\t{\"threads\": %u, \"parse_mb_s\": %.2f}%s\n", threads, best, threads * 2 <= max_threads ? "," : "");
+		}
+
+		std::printf("\t],\n");
+	}
+
+	/* Parser gerado pelo rjs_gen para o formato do ndjson, contra a leitura
+	 * genérica seguida da busca das mesmas chaves. */
+	{
+		const Corpus &ndjson = corpora[3];
+		rjs_parser_t parser;
+		char strings[256];
+		bench_log_t log;
+		double generic = 0.0, generated = 0.0;
+		std::size_t fast = 0;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+
+		for(int run = 0; run < 5; run++){
+			Clock::time_point start = Clock::now();
+			double mb_per_s;
+
+			for(std::size_t i = 0; i < ndjson.documents.size(); i++){
+				const rjs_object_t *object;
+
+				rjs_parse_string(&parser, ndjson.documents[i].c_str());
+				object = rjs_get_main_object(&parser);
+
+				checksum += rjs_get_vnumber(rjs_get_key(object, "ts"));
+				checksum += rjs_get_vstring(rjs_get_key(object, "level"))[0];
+				checksum += rjs_get_vstring(rjs_get_key(object, "service"))[0];
+				checksum += rjs_get_vnumber(rjs_get_key(object, "latency"));
+				checksum += rjs_get_vstring(rjs_get_key(object, "msg"))[0];
+			}
+
+			mb_per_s = ndjson.bytes / seconds_since(start) / 1e6;
+
+			if(mb_per_s > generic)
+				generic = mb_per_s;
+
+			start = Clock::now();
+			fast = 0;
+
+			for(std::size_t i = 0; i < ndjson.documents.size(); i++){
+				fast += bench_log_parse(ndjson.documents[i].c_str(), &log, strings, sizeof(strings), &parser) == 1;
+
+				checksum += log.ts + log.level[0] + log.service[0] + log.latency + log.msg[0];
+			}
+
+			mb_per_s = ndjson.bytes / seconds_since(start) / 1e6;
+
+			if(mb_per_s > generated)
+				generated = mb_per_s;
+		}
+
+		std::printf("\t\"generated\": {\"generic_mb_s\": %.2f, \"generated_mb_s\": %.2f, \"speedup\": %.2f, \"fast_path_ratio\": %.3f},\n",
+				generic, generated, generated / generic, (double) fast / ndjson.documents.size());
+	}
+
+	/* Edição pequena em um documento de cerca de 10 MB: a leitura completa
+	 * contra rjs_reparse, que só lê de novo o status editado. */
+	{
+		const Corpus big = generate_twitter(18 * scale);
+		std::string texts[2];
+		std::vector<char> big_arena(big.bytes * 4 + (1 << 24));
+		rjs_parser_t parser;
+		rjs_size_t position;
+		double full, incremental;
+		int current = 0;
+
+		texts[0] = big.documents[0];
+		position = texts[0].find("\"retweet_count\":", texts[0].size() / 2) + 16;
+		texts[1] = texts[0];
+		texts[1].insert(position, "1");
+
+		rjs_create_parser(&parser, big_arena.data(), big_arena.size());
+
+		full = bench_lookup(1, [&](){
+			checksum += rjs_parse_string(&parser, texts[0].c_str());
+		});
+
+		incremental = bench_lookup(100, [&](){
+			for(int i = 0; i < 100; i++){
+				/* Insere e remove o dígito, alternadamente. */
+				int next = !current;
+
+				if(!rjs_reparse(&parser, texts[next].c_str(), position, current, next)){
+					std::fprintf(stderr, "reparse: %s\n", rjs_get_error(&parser));
+					std::exit(1);
+				}
+
+				current = next;
+			}
+		});
+
+		std::printf("\t\"reparse\": {\"bytes\": %lu, \"full_parse_us\": %.1f, \"reparse_us\": %.2f, \"speedup\": %.0f},\n",
+				big.bytes, full / 1e3, incremental / 1e3, full / incremental);
+	}
+
+	/* Parsers donos da memória (r_json_arena.hpp) no mesmo documento de
+	 * 10 MB: a primeira leitura começa com 1 MB e cresce, as seguintes
+	 * reaproveitam a memória. O percurso compara páginas comuns e grandes, e
+	 * Key::get contra Object::walk. */
+	{
+		const Corpus big = generate_twitter(18 * scale);
+		const char *text = big.documents[0].c_str();
+		rjs_size_t size = big.bytes * 4 + (1 << 24);
+		rjs::ArenaParser growing(1 << 20);
+		rjs::ArenaParser common(size);
+		rjs::HugePageParser huge(size);
+		double first, reuse, common_walk, huge_walk, visitor_walk;
+		Clock::time_point start = Clock::now();
+
+		checksum += growing.parse(text);
+		first = seconds_since(start) * 1e3;
+
+		reuse = bench_lookup(1, [&](){
+			checksum += growing.parse(text);
+		}) / 1e6;
+
+		common.parse(text);
+		huge.parse(text);
+
+		common_walk = bench_lookup(1, [&](){
+			checksum += walk(common.getMainObject());
+		}) / 1e6;
+
+		huge_walk = bench_lookup(1, [&](){
+			checksum += walk(huge.getMainObject());
+		}) / 1e6;
+
+		visitor_walk = bench_lookup(1, [&](){
+			NumberSum sum = { 0.0 };
+
+			common.getMainObject().walk(sum);
+			checksum += sum.sum;
+		}) / 1e6;
+
+		std::printf("\t\"arena\": {\"first_parse_ms\": %.2f, \"reuse_parse_ms\": %.2f, \"grown_capacity\": %lu, \"walk_ms\": %.2f, \"huge_page_walk_ms\": %.2f, \"visitor_walk_ms\": %.2f},\n",
+				first, reuse, growing.capacity(), common_walk, huge_walk, visitor_walk);
+	}
+
+	/* Conversão das coordenadas do canada para double, em nanosegundos por
+	 * número: Key::get elemento a elemento, Object::copyTo,
+	 * rjs_array_to_doubles e Object::to<std::vector<double>>, nas arrays
+	 * comuns e nas compactadas. */
+	{
+		const Corpus &canada = corpora[1];
+		std::vector<double> out(2);
+		double results[2][4];
+		rjs_size_t numbers = 0;
+
+		std::vector<char> cpp_arena(arena.size());
+
+		for(int packed = 0; packed < 2; packed++){
+			rjs_parser_t parser;
+			rjs::Parser cpp_parser(cpp_arena.data(), cpp_arena.size());
+			std::vector<rjs::Object> points;
+			std::vector<const rjs_object_t *> c_points;
+			const rjs_key_t *feature;
+
+			/* O mesmo documento é lido duas vezes, para as arrays da API em C
+			 * e as da API em C++. */
+			rjs_create_parser(&parser, arena.data(), arena.size());
+			rjs_set_flags(&parser, packed ? RJS_FLAG_PACK_NUMBERS : 0);
+			rjs_parse_string(&parser, canada.documents[0].c_str());
+			cpp_parser.setFlags(packed ? RJS_FLAG_PACK_NUMBERS : 0);
+			cpp_parser.parse(canada.documents[0].c_str());
+
+			feature = rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "features"))->start_key;
+			for(; feature != NULL; feature = feature->next){
+				const rjs_object_t *geometry = rjs_get_vobj(rjs_get_key(rjs_get_vobj(feature), "geometry"));
+				const rjs_key_t *ring = rjs_get_vobj(rjs_get_key(geometry, "coordinates"))->start_key;
+
+				for(; ring != NULL; ring = ring->next){
+					for(const rjs_key_t *point = rjs_get_vobj(ring)->start_key; point != NULL; point = point->next)
+						c_points.push_back(rjs_get_vobj(point));
+				}
+			}
+
+			for(rjs::Key f = cpp_parser.getMainObject()["features"].get<rjs::Object>()[0]; f.isValid(); f.next()){
+				rjs::Object coordinates = f.get<rjs::Object>()["geometry"].get<rjs::Object>()["coordinates"].get<rjs::Object>();
+
+				for(rjs::Key ring = coordinates[0]; ring.isValid(); ring.next()){
+					for(rjs::Key point = ring.get<rjs::Object>()[0]; point.isValid(); point.next())
+						points.push_back(point.get<rjs::Object>());
+				}
+			}
+
+			numbers = points.size() * 2;
+
+			results[packed][0] = bench_lookup(numbers, [&](){
+				for(std::size_t i = 0; i < points.size(); i++){
+					for(rjs_size_t j = 0; j < points[i].size(); j++)
+						out[j] = points[i][j].get<double>();
+
+					checksum += out[0] + out[1];
+				}
+			});
+
+			results[packed][1] = bench_lookup(numbers, [&](){
+				for(std::size_t i = 0; i < points.size(); i++){
+					points[i].copyTo(out.data(), out.size());
+					checksum += out[0] + out[1];
+				}
+			});
+
+			results[packed][2] = bench_lookup(numbers, [&](){
+				rjs_size_t count;
+
+				for(std::size_t i = 0; i < c_points.size(); i++){
+					rjs_array_to_doubles(c_points[i], out.data(), out.size(), &count);
+					checksum += out[0] + out[1];
+				}
+			});
+
+			results[packed][3] = bench_lookup(numbers, [&](){
+				for(std::size_t i = 0; i < points.size(); i++){
+					std::vector<double> vector = points[i].to<std::vector<double>>();
+
+					checksum += vector[0] + vector[1];
+				}
+			});
+		}
+
+		std::printf("\t\"bulk\": {\"numbers\": %lu, \"key_get_ns\": %.2f, \"copy_to_ns\": %.2f, \"rjs_array_to_doubles_ns\": %.2f, \"to_vector_ns\": %.2f, "
+				"\"packed_key_get_ns\": %.2f, \"packed_copy_to_ns\": %.2f, \"packed_rjs_array_to_doubles_ns\": %.2f, \"packed_to_vector_ns\": %.2f},\n",
+				numbers, results[0][0], results[0][1], results[0][2], results[0][3], results[1][0], results[1][1], results[1][2], results[1][3]);
+	}
+
+	/* Os logs do ndjson em uma array, mantendo só os erros acima de 500 ms:
+	 * leitura completa seguida de rjs_get_key em cada elemento, contra os
+	 * predicados avaliados durante a leitura. */
+	{
+		const Corpus &ndjson = corpora[3];
+		std::string text = "{\"logs\":[";
+		rjs_predicate_t predicates[2];
+		rjs_parser_t parser;
+		rjs_size_t matches = 0, full_bytes, filtered_bytes;
+		double full, filtered;
+
+		for(std::size_t i = 0; i < ndjson.documents.size(); i++){
+			if(i != 0) text += ',';
+			text += ndjson.documents[i];
+		}
+
+		text += "]}";
+
+		predicates[0].name = "level";
+		predicates[0].op = RJS_FILTER_EQUAL;
+		predicates[0].type = RJS_KEY_STRING;
+		predicates[0].str = "error";
+		predicates[1].name = "latency";
+		predicates[1].op = RJS_FILTER_GREATER;
+		predicates[1].type = RJS_KEY_NUMBER;
+		predicates[1].number = 500;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+
+		full = bench_lookup(1, [&](){
+			const rjs_key_t *key;
+
+			matches = 0;
+			rjs_parse_string(&parser, text.c_str());
+
+			key = rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "logs"))->start_key;
+			for(; key != NULL; key = key->next){
+				const rjs_object_t *log = rjs_get_vobj(key);
+
+				if(std::strcmp(rjs_get_vstring(rjs_get_key(log, "level")), "error") == 0 && rjs_get_vnumber(rjs_get_key(log, "latency")) > 500)
+					matches++;
+			}
+
+			checksum += matches;
+		}) / 1e6;
+
+		full_bytes = parser.memory.top + parser.memory.size - parser.memory.string_top;
+
+		rjs_set_filter(&parser, predicates, 2, 1);
+
+		filtered = bench_lookup(1, [&](){
+			rjs_parse_string(&parser, text.c_str());
+			checksum += rjs_get_length(rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "logs")));
+		}) / 1e6;
+
+		filtered_bytes = parser.memory.top + parser.memory.size - parser.memory.string_top;
+
+		if(rjs_get_length(rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "logs"))) != matches){
+			std::fprintf(stderr, "filter: %lu elementos, esperados %lu\n",
+					rjs_get_length(rjs_get_vobj(rjs_get_key(rjs_get_main_object(&parser), "logs"))), matches);
+			std::exit(1);
+		}
+
+		std::printf("\t\"filter\": {\"bytes\": %lu, \"kept\": %lu, \"rejected\": %lu, \"full_parse_and_test_ms\": %.2f, \"filtered_parse_ms\": %.2f, "
+				"\"full_arena_bytes\": %lu, \"filtered_arena_bytes\": %lu},\n",
+				(rjs_size_t) text.size(), matches, rjs_get_rejected(&parser), full, filtered, full_bytes, filtered_bytes);
+	}
+
+	/* Todos os caminhos do documento do twitter, buscados com rjs_get_path
+	 * (chave a chave) e com o índice de rjs_build_index, além do custo de
+	 * construí-lo. */
+	{
+		const Corpus &twitter = corpora[0];
+		std::vector<std::string> paths;
+		rjs_parser_t parser;
+		rjs_path_index_t index;
+		rjs_size_t keys, size, top;
+		double build, walk_ns, index_ns;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+		rjs_parse_string(&parser, twitter.documents[0].c_str());
+		collect_paths(rjs_get_main_object(&parser), std::string(), paths);
+
+		size = rjs_index_size(&parser, &keys);
+
+		top = parser.memory.top;
+
+		build = bench_lookup(1, [&](){
+			/* Devolve a memória da construção anterior. */
+			parser.memory.top = top;
+			checksum += rjs_build_index(&parser, &index);
+		}) / 1e6;
+
+		walk_ns = bench_lookup(paths.size(), [&](){
+			for(std::size_t i = 0; i < paths.size(); i++)
+				checksum += rjs_get_path(rjs_get_main_object(&parser), paths[i].c_str())->value.type;
+		});
+
+		index_ns = bench_lookup(paths.size(), [&](){
+			for(std::size_t i = 0; i < paths.size(); i++)
+				checksum += rjs_index_get(&index, paths[i].c_str())->value.type;
+		});
+
+		std::printf("\t\"path_index\": {\"paths\": %lu, \"keys\": %lu, \"index_bytes\": %lu, \"build_ms\": %.2f, \"rjs_get_path_ns\": %.1f, \"rjs_index_get_ns\": %.1f},\n",
+				(rjs_size_t) paths.size(), keys, size, build, walk_ns, index_ns);
+	}
+
+	/* Um documento de referência, lido uma vez, e um documento do ndjson por
+	 * requisição no mesmo bloco: rjs_parse_document e rjs_rollback contra
+	 * ler a referência de novo a cada requisição, com um documento por vez. */
+	{
+		const std::string &reference = corpora[2].documents[0];
+		const Corpus &requests = corpora[3];
+		rjs_parser_t parser;
+		rjs_mark_t mark;
+		rjs_size_t count = requests.documents.size() < 2000 ? requests.documents.size() : 2000;
+		double rollback, reparse;
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+
+		rollback = bench_lookup(count, [&](){
+			const rjs_object_t *main = rjs_parse_document(&parser, reference.c_str());
+
+			rjs_mark(&parser, &mark);
+
+			for(rjs_size_t i = 0; i < count; i++){
+				checksum += rjs_get_length(rjs_parse_document(&parser, requests.documents[i].c_str()));
+				rjs_rollback(&parser, &mark);
+			}
+
+			checksum += rjs_get_length(main);
+			rjs_clean_parser(&parser);
+		});
+
+		reparse = bench_lookup(count, [&](){
+			for(rjs_size_t i = 0; i < count; i++){
+				checksum += rjs_parse_string(&parser, reference.c_str());
+				checksum += rjs_parse_string(&parser, requests.documents[i].c_str());
+			}
+		});
+
+		std::printf("\t\"documents\": {\"reference_bytes\": %lu, \"requests\": %lu, \"rollback_request_us\": %.2f, \"reparse_request_us\": %.2f},\n",
+				(rjs_size_t) reference.size(), count, rollback / 1e3, reparse / 1e3);
+	}
+
+	/* Leitor de eventos no documento do twitter, em pedaços de 64 KB: todos
+	 * os eventos, uma extração que pula o que não usa, o objeto principal
+	 * inteiro pulado e o tempo até a primeira chave procurada, contra a
+	 * leitura completa com rjs_parse_string. */
+	{
+		const std::string &text = corpora[0].documents[0];
+		std::vector<char> buffer(1 << 16);
+		rjs_parser_t parser;
+		double events, extract, skip, first, dom;
+
+		/* Lê o texto com o leitor, chamando on_event para cada evento. */
+		auto read = [&](const std::function<bool(rjs_reader_t &, const rjs_event_t &)> &on_event){
+			rjs_reader_t reader;
+			rjs_event_t event;
+			rjs_size_t position = 0;
+			int status;
+
+			rjs_reader_create(&reader, buffer.data(), buffer.size());
+
+			while((status = rjs_reader_next(&reader, &event)) != RJS_READER_DONE){
+				if(status == RJS_READER_NEED_INPUT){
+					rjs_size_t size = text.size() - position < 65536 ? text.size() - position : 65536;
+
+					rjs_reader_feed(&reader, text.data() + position, size);
+					position += size;
+				}
+				else if(status != RJS_READER_EVENT || !on_event(reader, event)){
+					break;
+				}
+			}
+		};
+
+		auto is_key = [](const rjs_event_t &event, const char *name){
+			return event.type == RJS_EVENT_KEY && event.length == std::strlen(name) && std::memcmp(event.str, name, event.length) == 0;
+		};
+
+		events = bench_lookup(1, [&](){
+			read([&](rjs_reader_t &, const rjs_event_t &event){
+				checksum += event.type;
+				return true;
+			});
+		});
+
+		extract = bench_lookup(1, [&](){
+			read([&](rjs_reader_t &reader, const rjs_event_t &event){
+				if(is_key(event, "text") || is_key(event, "user") || is_key(event, "entities"))
+					rjs_reader_skip(&reader);
+				else if(event.type == RJS_EVENT_NUMBER)
+					checksum += event.number;
+
+				return true;
+			});
+		});
+
+		skip = bench_lookup(1, [&](){
+			read([&](rjs_reader_t &reader, const rjs_event_t &event){
+				if(event.type == RJS_EVENT_BEGIN_OBJECT)
+					rjs_reader_skip(&reader);
+
+				return true;
+			});
+		});
+
+		first = bench_lookup(1, [&](){
+			read([&](rjs_reader_t &, const rjs_event_t &event){
+				return !is_key(event, "screen_name");
+			});
+		});
+
+		rjs_create_parser(&parser, arena.data(), arena.size());
+
+		dom = bench_lookup(1, [&](){
+			checksum += rjs_parse_string(&parser, text.c_str());
+		});
+
+		std::printf("\t\"pull\": {\"events_mb_s\": %.2f, \"extract_mb_s\": %.2f, \"skip_mb_s\": %.2f, \"first_key_us\": %.2f, \"dom_parse_us\": %.1f},\n",
+				text.size() / events * 1e3, text.size() / extract * 1e3, text.size() / skip * 1e3, first / 1e3, dom / 1e3);
+	}
+
+#ifdef RJS_BENCH_GZIP
+	/* Documentos compactados com gzip: descompactar tudo na memória e depois
+	 * ler, contra a descompactação em pedaços de 64 KB em outra thread, lida
+	 * ao mesmo tempo pelo leitor de eventos. A velocidade é a do texto
+	 * descompactado, e a memória é a usada para o texto. */
+	{
+		std::vector<char> buffer(1 << 16);
+		const std::size_t chunk_size = 1 << 16;
+		const std::size_t chunks = 4;
+
+		/* Com um só núcleo, as duas threads não se sobrepõem. */
+		std::printf("\t\"gzip\": {\"cores\": %u, \"documents\": [\n", std::thread::hardware_concurrency());
+
+		for(int i = 0; i < 2; i++){
+			const std::string &text = corpora[i].documents[0];
+			std::string compressed = gzip_compress(text);
+			std::string decompressed(text.size(), '\0');
+			double full, stream;
+
+			full = bench_lookup(1, [&](){
+				bool fed = false;
+
+				gzip_decompress(compressed, decompressed);
+
+				read_events(buffer.data(), buffer.size(), [&](const char **chunk, std::size_t *size){
+					*chunk = decompressed.data();
+					*size = fed ? 0 : decompressed.size();
+					fed = true;
+				});
+			});
+
+			stream = bench_lookup(1, [&](){
+				rjs::GzipSource source(compressed.data(), compressed.size(), chunk_size, chunks);
+
+				read_events(buffer.data(), buffer.size(), [&](const char **chunk, std::size_t *size){
+					source.next(chunk, size);
+				});
+			});
+
+			std::printf("\t\t{\"name\": \"%s\", \"bytes\": %lu, \"compressed_bytes\": %lu, \"full_mb_s\": %.2f, \"stream_mb_s\": %.2f, \"full_text_bytes\": %lu, \"stream_text_bytes\": %lu}%s\n",
+					corpora[i].name.c_str(), (rjs_size_t) text.size(), (rjs_size_t) compressed.size(),
+					text.size() / full * 1e3, text.size() / stream * 1e3,
+					(rjs_size_t) text.size(), (rjs_size_t) (chunk_size * chunks), i == 0 ? "," : "");
+		}
+
+		std::printf("\t]},\n");
+	}
+#endif
+
+	std::printf("\t\"checksum\": %.1f\n}\n", checksum);
+
+	return 0;
+}
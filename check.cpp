@@ -0,0 +1,386 @@
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Verificação dos módulos de C++20, que o benchmark (compilado em C++11) não
+ * compila, e de casos da biblioteca que o benchmark não cobre. As verificações de tempo de compilação são static_assert; as
+ * outras imprimem o que falhou e fazem o programa retornar 1.
+ * Uso: make check */
+
+#include "r_json_static.hpp"
+#include "r_json_pull.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	int failures = 0;
+
+	void expect(bool condition, const char *what){
+		if(!condition){
+			std::printf("FAIL: %s\n", what);
+			failures++;
+		}
+	}
+
+	/* Valor do primeiro número do documento estático. */
+	template <rjs::detail::FixedString S>
+	constexpr double static_number(void){
+		return rjs::static_root<S>()->start_key->value.data.number;
+	}
+
+	/* Lê o mesmo texto em tempo de execução e compara o primeiro número. */
+	bool same_number(const char *text, double number){
+		std::vector<char> memory(1 << 12);
+		rjs_parser_t parser;
+
+		rjs_create_parser(&parser, memory.data(), memory.size());
+
+		if(!rjs_parse_string(&parser, text))
+			return false;
+
+		return rjs_get_main_object(&parser)->start_key->value.data.number == number;
+	}
+
+	/* Expoentes grandes não podem passar do maior double na conversão. */
+	static_assert(static_number<R"({"g": 1e256})">() > 1e255);
+	static_assert(static_number<R"({"min": 1e-300})">() > 0.0);
+	static_assert(static_number<R"({"max": 1.7976931348623157e308})">() > 1.79e308);
+	static_assert(static_number<R"({"max": 1.7976931348623157e308})">() < std::numeric_limits<double>::infinity());
+	static_assert(static_number<R"({"big": 1e400})">() == std::numeric_limits<double>::infinity());
+	static_assert(static_number<R"({"sub": 1e-320})">() > 0.0);
+	static_assert(static_number<R"({"zero": 0e400})">() == 0.0);
+	static_assert(static_number<R"({"huge": 1e99999999999})">() == std::numeric_limits<double>::infinity());
+	static_assert(static_number<R"({"tiny": 1e-99999999999})">() == 0.0);
+
+	void check_static(void){
+		using namespace rjs::literals;
+		rjs::Object config = R"({"threads": 4, "name": "r_json", "ratio": 2.5e-3, "tags": [true, null]})"_rjs;
+
+		expect(config["threads"].get<int>() == 4, "_rjs: number");
+		expect(config["name"].getType() == RJS_KEY_STRING, "_rjs: string");
+		expect(config["tags"].get<rjs::Object>().size() == 2, "_rjs: array");
+		expect(config["ratio"].get<double>() == static_number<R"({"ratio": 2.5e-3})">(), "static_object: same document");
+
+		expect(same_number(R"({"g": 1e256})", static_number<R"({"g": 1e256})">()), "1e256: same value at run time");
+		expect(same_number(R"({"max": 1.7976931348623157e308})", static_number<R"({"max": 1.7976931348623157e308})">()), "max double: same value at run time");
+		expect(same_number(R"({"min": 1e-300})", static_number<R"({"min": 1e-300})">()), "1e-300: same value at run time");
+		expect(same_number(R"({"big": -1e400})", static_number<R"({"big": -1e400})">()), "-1e400: same value at run time");
+		expect(same_number(R"({"sub": 1e-320})", static_number<R"({"sub": 1e-320})">()), "1e-320: same value at run time");
+		expect(same_number(R"({"huge": 1e99999999999})", static_number<R"({"huge": 1e99999999999})">()), "1e99999999999: same value at run time");
+		expect(same_number(R"({"tiny": -1e-99999999999})", static_number<R"({"tiny": -1e-99999999999})">()), "-1e-99999999999: same value at run time");
+	}
+
+	/* Linhas que são arrays não têm nomes de chaves. */
+	void check_columns(void){
+		const char *text = R"({"a": [[1, 2], {"x": 3}], "b": [{"y": 1, "x": 2}, {"x": 4}], "c": [1, 2]})";
+		std::vector<char> memory(1 << 12), plus_memory(1 << 12);
+		const char *names[] = { "x" };
+		double x[4];
+		double *columns[] = { x };
+		rjs_size_t rows;
+		rjs_parser_t parser;
+
+		rjs::Parser plus(plus_memory.data(), plus_memory.size());
+
+		rjs_create_parser(&parser, memory.data(), memory.size());
+		rjs_set_flags(&parser, RJS_FLAG_PACK_NUMBERS);
+
+		if(!rjs_parse_string(&parser, text) || !plus.parse(text)){
+			expect(false, "columns: parse");
+			return;
+		}
+
+		const rjs_object_t *root = rjs_get_main_object(&parser);
+		const rjs_object_t *a = rjs_get_vobj(rjs_get_key(root, "a"));
+		const rjs_object_t *b = rjs_get_vobj(rjs_get_key(root, "b"));
+		const rjs_object_t *c = rjs_get_vobj(rjs_get_key(root, "c"));
+
+		expect(!rjs_extract_columns(a, names, 1, columns, 4, &rows), "rjs_extract_columns: array row");
+		expect(!rjs_extract_columns(root, names, 1, columns, 4, &rows), "rjs_extract_columns: not an array");
+		expect(!rjs_extract_columns(c, names, 1, columns, 4, &rows), "rjs_extract_columns: packed array");
+		expect(!rjs_extract_columns(NULL, names, 1, columns, 4, &rows), "rjs_extract_columns: NULL");
+		expect(rjs_extract_columns(b, names, 1, columns, 4, &rows) && rows == 2 && x[0] == 2 && x[1] == 4, "rjs_extract_columns: rows");
+
+		rjs::Object plus_root = plus.getMainObject();
+		auto [a_x] = rjs::columns<double>(plus_root["a"].get<rjs::Object>(), "x");
+		auto [b_x] = rjs::columns<double>(plus_root["b"].get<rjs::Object>(), "x");
+		auto [root_x] = rjs::columns<double>(plus_root, "x");
+
+		expect(a_x.size() == 2 && a_x[0] == 0 && a_x[1] == 3, "rjs::columns: array row");
+		expect(b_x.size() == 2 && b_x[0] == 2 && b_x[1] == 4, "rjs::columns: rows");
+		expect(root_x.empty(), "rjs::columns: not an array");
+	}
+
+	bool same_object(const rjs_object_t *a, const rjs_object_t *b);
+
+	bool same_key(const rjs_key_t *a, const rjs_key_t *b){
+		if((a->name == NULL) != (b->name == NULL) || (a->name != NULL && std::strcmp(a->name, b->name) != 0))
+			return false;
+
+		if(a->value.type != b->value.type)
+			return false;
+
+		switch(a->value.type){
+			case RJS_KEY_STRING: return std::strcmp(rjs_get_vstring(a), rjs_get_vstring(b)) == 0;
+			case RJS_KEY_NUMBER: return rjs_get_vnumber(a) == rjs_get_vnumber(b);
+			case RJS_KEY_BOOLEAN: return rjs_get_vbool(a) == rjs_get_vbool(b);
+			case RJS_KEY_OBJECT: return same_object(rjs_get_vobj(a), rjs_get_vobj(b));
+			default: return true;
+		}
+	}
+
+	/* Compara dois documentos, inclusive as posições no texto, das quais
+	 * dependem as próximas chamadas de rjs_reparse. */
+	bool same_object(const rjs_object_t *a, const rjs_object_t *b){
+		const rjs_key_t *x = a->start_key, *y = b->start_key;
+
+		if(a->is_array != b->is_array || a->length != b->length || a->offset != b->offset || a->size != b->size)
+			return false;
+
+		for(; x != NULL && y != NULL; x = x->next, y = y->next){
+			if(!same_key(x, y))
+				return false;
+		}
+
+		return x == NULL && y == NULL;
+	}
+
+	/* Edições seguidas com rjs_reparse devem dar o mesmo documento que uma
+	 * leitura completa do texto novo. */
+	void check_reparse(void){
+		const char *texts[] = {
+			R"({"a": {"x": 1, "list": [1, {"y": "s"}, 3]}, "b": 2, "c": {"z": [true]}})",
+			R"({"a": {"x": 12, "list": [1, {"y": "s"}, 3]}, "b": 2, "c": {"z": [true]}})",
+			R"({"a": {"x": 12, "list": [1, {"y": "str"}, 3]}, "b": 2, "c": {"z": [true]}})",
+			R"({"a": {"x": 12, "list": [1, {"y": "str", "w": null}, 3]}, "b": 2, "c": {"z": [true]}})",
+			R"({"a": {"x": 12, "list": [1, {"y": "str", "w": null}, 3]}, "b": 2, "c": {"z": [false]}})",
+			R"({"a": {"x": 12, "list": [1, {"y": "str", "w": null}, 3]}, "b": 2, "c": {"z": []}})"
+		};
+		std::vector<char> memory(1 << 14), full_memory(1 << 14);
+		rjs_parser_t parser, full;
+
+		rjs_create_parser(&parser, memory.data(), memory.size());
+		rjs_create_parser(&full, full_memory.data(), full_memory.size());
+
+		if(!rjs_parse_string(&parser, texts[0])){
+			expect(false, "rjs_reparse: parse");
+			return;
+		}
+
+		for(std::size_t i = 1; i < sizeof(texts) / sizeof(texts[0]); i++){
+			std::string_view before(texts[i - 1]), after(texts[i]);
+			std::size_t start = 0, end = 0;
+
+			/* O trecho que mudou entre os dois textos. */
+			while(before[start] == after[start])
+				start++;
+
+			while(end < before.size() - start && end < after.size() - start
+					&& before[before.size() - 1 - end] == after[after.size() - 1 - end])
+				end++;
+
+			expect(rjs_reparse(&parser, texts[i], start, before.size() - start - end, after.size() - start - end), "rjs_reparse: edit");
+			expect(rjs_parse_string(&full, texts[i]) && same_object(rjs_get_main_object(&parser), rjs_get_main_object(&full)),
+					"rjs_reparse: same document as a full parse");
+		}
+
+		/* Depois das funções de edição, o documento não corresponde mais ao
+		 * texto, e é lido por inteiro. */
+		const char *edited = R"({"a": {"x": 1}, "b": 2})";
+		const char *changed = R"({"a": {"x": 5}, "b": 2})";
+		const rjs_object_t *root;
+
+		rjs_parse_string(&parser, edited);
+		root = rjs_get_main_object(&parser);
+		rjs_set_number(&parser, rjs_get_key(root, "b"), 99);
+		rjs_insert_key(&parser, root, "c");
+
+		expect(rjs_reparse(&parser, changed, 12, 1, 1), "rjs_reparse: after edits");
+		expect(rjs_parse_string(&full, changed) && same_object(rjs_get_main_object(&parser), rjs_get_main_object(&full)),
+				"rjs_reparse: edits are discarded");
+	}
+
+	/* Números preguiçosos apontam para o texto lido, em uma leitura inteira
+	 * ou em partes, e convertem para o mesmo valor da leitura comum. */
+	void check_lazy(void){
+		const char *text = R"({"id": 9007199254740993, "list": [1.5, -2e3,0], "x": {"y": 17}})";
+		std::vector<char> memory(1 << 12), eager_memory(1 << 12);
+		rjs_parser_t parser, eager;
+		rjs_size_t length;
+
+		rjs_create_parser(&eager, eager_memory.data(), eager_memory.size());
+		rjs_create_parser(&parser, memory.data(), memory.size());
+		rjs_set_flags(&parser, RJS_FLAG_LAZY_NUMBERS);
+
+		for(rjs_size_t budget = 1; budget <= 64; budget *= 4){
+			int status;
+
+			rjs_parse_begin(&parser, text);
+
+			while((status = rjs_parse_step_budget(&parser, budget)) == RJS_PARSE_IN_PROGRESS);
+
+			expect(status == RJS_PARSE_DONE && rjs_parse_string(&eager, text)
+					&& same_object(rjs_get_main_object(&parser), rjs_get_main_object(&eager)), "lazy numbers: same values");
+		}
+
+		const rjs_object_t *root = rjs_get_main_object(&parser);
+		const rjs_key_t *second = rjs_get_key_index(rjs_get_vobj(rjs_get_key(root, "list")), 1);
+		const char *raw = rjs_get_vraw(second, &length);
+
+		expect(raw == std::strstr(text, "-2e3") && length == 4, "rjs_get_vraw: points into the text");
+
+		/* Os valores postos pelas funções de edição não são preguiçosos. */
+		const rjs_object_t *list = rjs_get_vobj(rjs_get_key(root, "list"));
+
+		rjs_set_string(&parser, rjs_get_key_index(list, 0), "s");
+		rjs_set_bool(&parser, rjs_get_key_index(list, 1), 1);
+		rjs_set_null(&parser, rjs_get_key_index(list, 2));
+		rjs_set_object(&parser, rjs_get_key(root, "id"), rjs_new_object(&parser, 0));
+
+		expect(!rjs_get_key_index(list, 0)->value.is_lazy && !rjs_get_key_index(list, 1)->value.is_lazy
+				&& !rjs_get_key_index(list, 2)->value.is_lazy && !rjs_get_key(root, "id")->value.is_lazy, "edits clear is_lazy");
+
+		rjs::Parser plus(memory.data(), memory.size());
+		plus.setFlags(RJS_FLAG_LAZY_NUMBERS);
+		plus.parse(text);
+
+		rjs::Key plus_id = plus.getMainObject()["id"];
+
+		expect(plus_id.get<long long>() == 9007199254740993LL, "lazy numbers: exact 64-bit integer");
+		expect(plus.cacheNumber(plus_id) == 9007199254740992.0 && plus_id.getRaw() == nullptr, "cacheNumber: stored in the key");
+	}
+
+	const char *pull_text = R"({"id": 7, "user": {"name": "a\"b", "tags": ["x", "y"]}, "text": "long string", "count": 12.5, "ok": true})";
+
+	/* Entrega o texto em pedaços de size bytes, para que tokens fiquem
+	 * divididos entre dois pedaços. */
+	rjs::PullParser::Source chunks(const char *text, std::size_t size){
+		std::string_view rest(text);
+
+		return [rest, size]() mutable {
+			std::string_view chunk = rest.substr(0, size);
+
+			rest.remove_prefix(chunk.size());
+
+			return chunk;
+		};
+	}
+
+	void check_pull(void){
+		char buffer[64];
+
+		/* Todos os eventos, com pedaços de 1 a 7 bytes. */
+		for(std::size_t size = 1; size <= 7; size++){
+			rjs::PullParser parser(chunks(pull_text, size), buffer, sizeof(buffer));
+			rjs::Event event;
+			std::string name;
+			double count = 0;
+			int events = 0;
+
+			while(parser.next(event)){
+				if(event.isKey("name") && parser.next(event))
+					name = std::string(event.text);
+				else if(event.isKey("count") && parser.next(event))
+					count = event.number;
+
+				events++;
+			}
+
+			expect(!parser.failed(), "PullParser: chunked input");
+			expect(name == "a\"b", "PullParser: escaped string across chunks");
+			expect(count == 12.5, "PullParser: number across chunks");
+			expect(events == 18, "PullParser: event count");
+		}
+
+		/* skip pula o objeto user inteiro. */
+		{
+			rjs::PullParser parser(chunks(pull_text, 3), buffer, sizeof(buffer));
+			rjs::Event event;
+			bool saw_tags = false, saw_count = false;
+
+			while(parser.next(event)){
+				if(event.isKey("user"))
+					expect(parser.skip(), "PullParser: skip");
+
+				saw_tags = saw_tags || event.isKey("tags");
+				saw_count = saw_count || event.isKey("count");
+			}
+
+			expect(!parser.failed() && !saw_tags && saw_count, "PullParser: skipped object");
+		}
+
+		/* Parar no meio não lê o resto do texto. */
+		{
+			std::size_t requested = 0;
+			rjs::PullParser::Source source = chunks(pull_text, 4);
+			rjs::PullParser parser([&](){ requested++; return source(); }, buffer, sizeof(buffer));
+			rjs::Event event;
+
+			while(parser.next(event)){
+				if(event.isKey("id"))
+					break;
+			}
+
+			expect(requested < 4, "PullParser: early exit");
+		}
+
+		/* Um texto cortado é um erro. */
+		{
+			rjs::PullParser parser(std::string_view(pull_text, 20), buffer, sizeof(buffer));
+			rjs::Event event;
+
+			while(parser.next(event));
+
+			expect(parser.failed(), "PullParser: truncated input");
+		}
+
+#ifdef RJS_PULL_COROUTINE
+		{
+			rjs::PullParser parser(chunks(pull_text, 5), buffer, sizeof(buffer));
+			int numbers = 0;
+
+			for(const rjs::Event &event : parser.events()){
+				if(event.isKey("text"))
+					break;
+
+				numbers += event.type == RJS_EVENT_NUMBER;
+			}
+
+			expect(numbers == 1, "PullParser: events() with early exit");
+		}
+#endif
+	}
+};
+
+int main(void){
+	check_static();
+	check_columns();
+	check_reparse();
+	check_lazy();
+	check_pull();
+
+	if(failures != 0)
+		return 1;
+
+	std::printf("ok\n");
+
+	return 0;
+}
@@ -17,6 +17,25 @@
  *	  Copyright	Gabriel Martins (C) 2025
 */
 
+/* Com RJS_ENABLE_SIMD, a leitura de strings utiliza SSE2 para encontrar o fim
+ * de sequências de caracteres ASCII. O header é do compilador, não da
+ * standard library. */
+#if defined(RJS_ENABLE_SIMD) && defined(__SSE2__) && defined(__GNUC__)
+	#include <emmintrin.h>
+
+	/* As leituras alinhadas de rjs_scan_plain podem passar do fim da string,
+	 * e não devem ser instrumentadas pelo AddressSanitizer. */
+	#if defined(__has_attribute)
+		#if __has_attribute(no_sanitize_address)
+			#define RJS_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+		#endif
+	#endif
+
+	#ifndef RJS_NO_SANITIZE_ADDRESS
+		#define RJS_NO_SANITIZE_ADDRESS
+	#endif
+#endif
+
 /* A biblioteca não depende da standard library, por isso a definição de NULL */
 
 #ifndef NULL
@@ -27,6 +46,54 @@
 	#endif
 #endif
 
+/* Alinhamento das chaves e objetos, suficiente para ponteiros e doubles. */
+#define RJS_ALIGNMENT 8
+
+/* Alinhamento das arrays compactadas, para que comecem em uma linha de cache. */
+#define RJS_CACHE_LINE 64
+
+/* Base e primo do hash FNV-1a dos caminhos do índice. Os valores de 32 bits
+ * cabem em qualquer unsigned long. */
+#define RJS_HASH_BASIS 2166136261UL
+#define RJS_HASH_PRIME 16777619UL
+
+/* Quantidade de nomes buscados em cada percurso de rjs_get_keys. */
+#define RJS_KEYS_BATCH 32
+
+/* Grupos de nomes, separados pelo primeiro caractere, em rjs_get_keys. */
+#define RJS_KEYS_BUCKETS 32
+
+/* Pontos de rastreamento (USDT) do provider r_json, para perf, bpftrace e
+ * SystemTap. Sem RJS_ENABLE_USDT, as macros não geram código. O header é do
+ * SystemTap e contém apenas macros, sem depender de uma biblioteca. */
+#ifdef RJS_ENABLE_USDT
+	#include <sys/sdt.h>
+	#define RJS_PROBE2(name, a, b) DTRACE_PROBE2(r_json, name, a, b)
+	#define RJS_PROBE3(name, a, b, c) DTRACE_PROBE3(r_json, name, a, b, c)
+	#define RJS_PROBE4(name, a, b, c, d) DTRACE_PROBE4(r_json, name, a, b, c, d)
+	#define RJS_PROBE5(name, a, b, c, d, e) DTRACE_PROBE5(r_json, name, a, b, c, d, e)
+#else
+	#define RJS_PROBE2(name, a, b) ((void) 0)
+	#define RJS_PROBE3(name, a, b, c) ((void) 0)
+	#define RJS_PROBE4(name, a, b, c, d) ((void) 0)
+	#define RJS_PROBE5(name, a, b, c, d, e) ((void) 0)
+#endif
+
+/* Coleta de estatísticas. Sem RJS_ENABLE_STATS, as macros não geram código. */
+#ifdef RJS_ENABLE_STATS
+	#define RJS_STAT_ADD(parser, field, n) \
+		do{ if((parser)->stats != NULL) (parser)->stats->field += (n); }while(0)
+	#define RJS_STAT_MAX(parser, field, n) \
+		do{ if((parser)->stats != NULL && (parser)->stats->field < (n)) (parser)->stats->field = (n); }while(0)
+#else
+	#define RJS_STAT_ADD(parser, field, n) ((void) 0)
+	#define RJS_STAT_MAX(parser, field, n) ((void) 0)
+#endif
+
+#if defined(RJS_ENABLE_STATS) && defined(RJS_ENABLE_STATS_CYCLES) && (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+	#define RJS_CYCLES() ((unsigned long) __builtin_ia32_rdtsc())
+#endif
+
 /* Estados possíveis para o parser. */
 enum rjs_states_e {
 	RJS_SEARCH_OPEN_BRACKET = 0,
@@ -36,10 +103,29 @@ enum rjs_states_e {
 	RJS_SEARCH_VALUE,
 	RJS_READ_VALUE_STRING,
 	RJS_READ_VALUE_STRING_CONTROL,
+	RJS_READ_VALUE_STRING_UNICODE,
 	RJS_READ_VALUE_NUMBER,
 	RJS_READ_TOKEN_STRING
 };
 
+/* Estados do leitor de eventos. Os estados até RJS_EXPECT_END pulam
+ * espaços entre os elementos. */
+enum rjs_reader_states_e {
+	RJS_EXPECT_ROOT = 0,
+	RJS_EXPECT_KEY,
+	RJS_EXPECT_COLON,
+	RJS_EXPECT_VALUE,
+	RJS_EXPECT_END,
+	RJS_IN_STRING,
+	RJS_IN_STRING_CONTROL,
+	RJS_IN_STRING_UNICODE,
+	RJS_IN_NUMBER,
+	RJS_IN_LITERAL,
+	RJS_IN_SKIP,
+	RJS_FINISHED,
+	RJS_FAILED
+};
+
 enum rjs_strtod_states_e {
 	RJS_STRTOD_READ_NUMBER,
 	RJS_STRTOD_READ_FRACTION,
@@ -54,27 +140,60 @@ static const char *names[] = {
 	"null"
 };
 
-/* Armazena uma mensagem de erro, com a indicação de qual linha o erro
- * aconteceu. */
-static void rjs_log(rjs_parser_t *parser, const char *message);
+/* Armazena o erro em parser->error e a mensagem, com a indicação de qual linha
+ * o erro aconteceu. A linha e a coluna são calculadas percorrendo a entrada
+ * até input_index. expected pode ser NULL. */
+static void rjs_log(rjs_parser_t *parser, int code, const char *expected, const char *message);
+
+/* Escreve a mensagem de erro e a linha em log, que tem RJS_MAX_STRING_SIZE
+ * bytes. Usada pelo parser e pelo leitor de eventos. */
+static void rjs_write_log(char *log, int line_count, const char *message);
 
 /* Adiciona um caractere na string, verificando se ainda há espaço disponível.
  * Retorna 0 caso não haja. */
 static int rjs_add_character(char *str, rjs_size_t pos, char ch);
 
+/* Adiciona um caractere na string sendo lida, seja ela o nome da chave ou o
+ * valor. */
+static void rjs_add_string_character(rjs_parser_t *parser, char ch);
+
+/* Adiciona um code point, codificado em UTF-8, na string sendo lida. */
+static void rjs_add_codepoint(rjs_parser_t *parser, unsigned long codepoint);
+
+/* Codifica o code point em UTF-8 em out, que deve ter 4 bytes. Retorna a
+ * quantidade de bytes escritos. */
+static int rjs_encode_utf8(unsigned long codepoint, char *out);
+
+/* Retorna o valor de um dígito hexadecimal, ou -1 caso não seja um. */
+static int rjs_hex_digit(char c);
+
+/* Avança o validador de UTF-8 com mais um byte (não ASCII) da string.
+ * Retorna 0 caso a sequência seja inválida. */
+static int rjs_validate_utf8(rjs_parser_t *parser, unsigned char c);
+
+/* Retorna a posição do primeiro caractere a partir de index que não seja ASCII,
+ * aspas, barra invertida ou o fim da string. */
+static rjs_size_t rjs_scan_plain(const char *str, rjs_size_t index);
+
 /* Retorna 1 se o caractere é um whitespace, 0 caso contrário. */
 static int rjs_isspace(char c);
 
 /* Retorna 1 se pode ser um número inicial (-, 0 .. 9), 0 caso contrário. */
 static int rjs_isstartnumber(char c);
 
-static double rjs_pow(double number, int exponent);
+/* Retorna 10 elevado a exponent (não negativo), com as potências 10^(2^k)
+ * exatas de uma tabela, para que o erro não cresça a cada multiplicação. */
+static double rjs_pow10(int exponent);
 
 /* Converte uma string para um número do tipo double. O número deve ser passado
  * por referência.
  * Caso ocorra com sucesso, retorna 1, 0 caso contrário. */
 static int rjs_strtod(const char *str, double *ret_number);
 
+/* Verifica se a string é um número aceito por rjs_strtod, sem convertê-lo.
+ * Retorna 1 caso seja. */
+static int rjs_check_number(const char *str);
+
 /* Faz uma comparação entre n caracteres.
  * Retorna 0 caso sejam iguais. */
 static int rjs_strncmp(const char *str1, const char *str2, rjs_size_t n);
@@ -83,17 +202,44 @@ static int rjs_strncmp(const char *str1, const char *str2, rjs_size_t n);
  * Retorna 0 caso sejam iguais. */
 static int rjs_strcmp(const char *str1, const char *str2);
 
-/* Aloca a quantidade desejada de memória no parser. Caso não haja mais memória,
- * marca a flag de falta de memória e retorna NULL. */
+/* Retorna quantos bytes faltam para que o endereço esteja alinhado. */
+static rjs_size_t rjs_align_padding(const void *location, rjs_size_t alignment);
+
+/* Aloca a quantidade desejada de memória no parser, com o alinhamento dado.
+ * Caso não haja mais memória, marca a flag de falta de memória e retorna NULL. */
+static void *rjs_alloc_aligned(rjs_parser_t *parser, rjs_size_t size, rjs_size_t alignment);
+
+/* Aloca a quantidade desejada de memória no parser, alinhada para chaves e
+ * objetos. Caso não haja mais memória, marca a flag de falta de memória e
+ * retorna NULL. */
 static void *rjs_alloc(rjs_parser_t *parser, rjs_size_t size);
 
-/* Aloca uma string na memória e retorna um ponteiro para ela. Caso não haja
- * mais memória, retorna NULL. */
+/* Aloca uma string na região de strings e retorna um ponteiro para ela. Caso
+ * não haja mais memória, retorna NULL. */
 static const char *rjs_pushstring(rjs_parser_t *parser, const char *str);
 
 /* Aloca um objeto na memória, retornando NULL caso não haja mais memória. */
 static rjs_object_t *rjs_create_obj(rjs_parser_t *parser);
 
+/* Caso todos os elementos da array sejam números, troca as suas chaves por
+ * uma array contígua de doubles, devolvendo a memória das chaves. */
+static void rjs_pack_numbers(rjs_parser_t *parser, rjs_object_t *obj);
+
+/* Tira o objeto do topo da pilha ao fim da sua leitura, sendo end a posição
+ * logo após o seu fechamento, e torna a sua posição relativa ao pai. */
+static void rjs_stack_closeobject(rjs_parser_t *parser, rjs_size_t end);
+
+/* Lê de novo, de forma isolada, o objeto que começa em start no texto novo.
+ * Retorna o novo objeto, ou NULL caso a leitura falhe. */
+static rjs_object_t *rjs_parse_region(rjs_parser_t *parser, const char *str, rjs_size_t start, int is_array);
+
+/* Troca os números de uma array compactada por chaves, para que ela possa
+ * ser editada. Retorna 0 caso não haja memória. */
+static int rjs_unpack_numbers(rjs_parser_t *parser, rjs_object_t *obj);
+
+/* Remove a chave dada do objeto, sendo previous a chave anterior a ela. */
+static void rjs_obj_removekey(rjs_object_t *obj, rjs_key_t *previous, rjs_key_t *key);
+
 /* Põe um objeto no topo da pilha, indicando que esse é o objeto a ser lido.
  * Caso não haja mais espaço na pilha, retorna 0, 1 caso contrário. */
 static int rjs_stack_pushobject(rjs_parser_t *parser, rjs_object_t *obj);
@@ -105,14 +251,19 @@ static int rjs_stack_popobject(rjs_parser_t *parser);
 /* Retorna o objeto no topo da pilha. Caso não haja objetos, retorna NULL. */
 static rjs_object_t * rjs_stack_top(rjs_parser_t *parser);
 
+/* Aloca uma chave de um dado tipo para o objeto. O nome só é armazenado caso
+ * o objeto não seja uma array. Retorna NULL caso não haja mais memória. */
+static rjs_key_t *rjs_alloc_key(rjs_parser_t *parser, rjs_object_t *obj, const char *key, int type);
+
 /* Cria uma chave em um objeto, retornando 0 caso haja falhas. */
 static int rjs_obj_pushkey(rjs_parser_t *parser, rjs_object_t *obj, rjs_key_t *key);
 
 /* Cria uma chave do tipo string em um objeto, retornado 0 caso haja falhas. */
 static int rjs_obj_pushkey_string(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str);
 
-/* Cria uma chave do tipo número em um objeto, retornando 0 caso haja falhas. */
-static int rjs_obj_pushkey_number(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str);
+/* Cria uma chave do tipo número em um objeto, retornando 0 caso haja falhas.
+ * str é o número, copiado, e raw é onde ele começa no texto lido. */
+static int rjs_obj_pushkey_number(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str, const char *raw);
 
 /* Cria uma chave do tipo objeto em um objeto, retornando 0 caso haja falhas. */
 static int rjs_obj_pushkey_obj(rjs_parser_t *parser, rjs_object_t *obj, const char *key, rjs_object_t *new_obj);
@@ -123,12 +274,110 @@ static int rjs_obj_pushkey_bool(rjs_parser_t *parser, rjs_object_t *obj, const c
 /* Cria uma chave do tipo null em um objeto, retornando 0 caso haja falhas. */
 static int rjs_obj_pushkey_null(rjs_parser_t *parser, rjs_object_t *obj, const char *key);
 
-/* Faz a leitura da string, retornando 0 caso haja erros. */
-static int rjs_parse_object(rjs_parser_t *parser, const char *str, rjs_size_t *index);
+/* Começa a filtrar o objeto obj, elemento de array, guardando o estado da
+ * memória antes dele (top) e o fim da array, para que possa ser descartado. */
+static void rjs_filter_begin(rjs_parser_t *parser, rjs_object_t *array, rjs_object_t *obj, rjs_size_t top);
+
+/* Aplica os predicados com o nome da chave recém-criada no elemento filtrado,
+ * descartando-o caso algum deles falhe. */
+static void rjs_filter_key(rjs_parser_t *parser, const rjs_key_t *key);
+
+/* Retorna 1 caso o valor da chave satisfaça o predicado, 0 caso contrário. */
+static int rjs_filter_match(const rjs_predicate_t *predicate, const rjs_key_t *key);
+
+/* Termina o elemento filtrado ao seu fechamento, mantendo-o caso tenha
+ * satisfeito todos os predicados. */
+static void rjs_filter_close(rjs_parser_t *parser);
+
+/* Descarta o elemento filtrado, devolvendo a memória usada por ele. Caso
+ * skip seja 1, o resto do elemento ainda não foi lido e é percorrido até o
+ * seu fechamento. */
+static void rjs_filter_reject(rjs_parser_t *parser, int skip);
+
+/* Compara o trecho do caminho que começa em segment, até o próximo '/',
+ * com o nome dado, decodificando "~0" e "~1". Retorna 1 caso sejam iguais. */
+static int rjs_path_match(const char *segment, const char *name);
+
+/* Lê a posição de um elemento no trecho do caminho que começa em segment.
+ * Retorna 0 caso o trecho não seja um número decimal sem zeros à esquerda. */
+static int rjs_path_position(const char *segment, rjs_size_t *position);
+
+/* Continua o hash com um '/' e o trecho de caminho str, até o '\0' ou,
+ * caso decode seja 1, o próximo '/', decodificando "~0" e "~1". */
+static rjs_size_t rjs_hash_path(rjs_size_t hash, const char *str, int decode);
+
+/* Retorna a quantidade de posições da tabela do índice para keys chaves. */
+static rjs_size_t rjs_index_capacity(rjs_size_t keys);
+
+/* Põe no índice as chaves do objeto e dos seus filhos, sendo parent a
+ * posição da entrada do objeto mais 1 e hash o hash do seu caminho. */
+static void rjs_index_object(rjs_path_index_t *index, const rjs_object_t *object, rjs_size_t parent, rjs_size_t hash);
+
+/* Confere se a entrada na posição slot, e as dos seus pais, correspondem ao
+ * caminho entre path e end. */
+static int rjs_index_match(const rjs_path_index_t *index, rjs_size_t slot, const char *path, const char *end);
+
+/* Estrutura com a quantidade de cada elemento de um documento, utilizada
+ * para calcular o tamanho de uma cópia compactada. */
+typedef struct {
+	rjs_size_t objects;
+	rjs_size_t keys;
+	rjs_size_t numbers;
+	rjs_size_t chars;
+} rjs_count_t;
+
+/* Arredonda o tamanho para um múltiplo do alinhamento das chaves. */
+static rjs_size_t rjs_align_size(rjs_size_t size);
+
+/* Conta os elementos de um objeto e de todos os seus filhos. */
+static void rjs_count_object(const rjs_object_t *object, rjs_count_t *count);
+
+/* Copia uma string para a posição cursor, avançando-o. */
+static const char *rjs_copy_string(char **cursor, const char *str);
+
+/* Volta o estado da leitura ao inicial, sem tocar na memória. */
+static void rjs_reset_state(rjs_parser_t *parser);
+
+/* Começa a leitura de um documento na memória livre do parser. */
+static int rjs_begin_document(rjs_parser_t *parser, const char *str);
+
+/* Lê de novo o último documento, a partir do texto str, na memória que ele
+ * ocupava, sem tocar nos documentos anteriores. */
+static int rjs_parse_again(rjs_parser_t *parser, const char *str);
+
+/* Continua a leitura da string do parser, lendo aproximadamente até
+ * max_bytes bytes. Retorna RJS_PARSE_DONE, RJS_PARSE_IN_PROGRESS ou
+ * RJS_PARSE_ERROR. */
+static int rjs_parse_object(rjs_parser_t *parser, rjs_size_t max_bytes);
 
 /* Representa uma iteração da leitura da string, retornando 0 caso haja erros. */
 static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size_t *index);
 
+/* Guarda o erro do leitor de eventos e o deixa no estado de erro. Retorna
+ * RJS_READER_ERROR. */
+static int rjs_reader_error(rjs_reader_t *reader, const char *message);
+
+/* Copia length bytes para o buffer do leitor, deixando espaço para o '\0'.
+ * Retorna 0 caso não caibam. */
+static int rjs_reader_copy(rjs_reader_t *reader, const char *str, rjs_size_t length);
+
+/* Copia para o buffer a parte da string atual que está no pedaço, até a
+ * posição atual. Retorna 0 caso não caiba. */
+static int rjs_reader_flush(rjs_reader_t *reader);
+
+/* Abre um objeto ou array. Retorna 0 caso a profundidade máxima seja
+ * alcançada. */
+static int rjs_reader_push(rjs_reader_t *reader, int is_array);
+
+/* Fecha o objeto ou array do topo com o caractere current, escrevendo o
+ * evento de fim. Retorna RJS_READER_EVENT ou RJS_READER_ERROR. */
+static int rjs_reader_close(rjs_reader_t *reader, char current, rjs_event_t *event);
+
+/* Completa o evento com o tipo e a profundidade. Retorna 0 caso o evento
+ * seja de um valor que deve ser pulado (veja rjs_reader_skip), e então não
+ * deve ser entregue. */
+static int rjs_reader_emit(rjs_reader_t *reader, rjs_event_t *event, int type);
+
 int rjs_create_parser(rjs_parser_t *parser, char *block, rjs_size_t size){
 	if(block == NULL)
 		return 0;
@@ -136,517 +385,2596 @@ int rjs_create_parser(rjs_parser_t *parser, char *block, rjs_size_t size){
 	parser->memory.block = block;
 	parser->memory.size = size;
 	parser->memory.top = 0;
+	parser->memory.string_top = size;
 
 	parser->start_object = NULL;
+	parser->document_top = 0;
+	parser->document_string_top = size;
+	parser->edited = 0;
+	parser->flags = 0;
+	parser->stats = NULL;
+	parser->input = NULL;
+	parser->status = RJS_PARSE_ERROR;
+
+	parser->filters = NULL;
+	parser->filter_count = 0;
+	parser->filter_depth = 0;
+	parser->filter_element = NULL;
+	parser->filter_rejected = 0;
+
+	parser->generation = 0;
+
+	parser->error.code = RJS_ERROR_NONE;
+	parser->error.expected = NULL;
+	parser->error_log[0] = '\0';
 	
 	return 1;
 }
 
 int rjs_clean_parser(rjs_parser_t *parser){
 	parser->memory.top = 0;
+	parser->memory.string_top = parser->memory.size;
 	parser->start_object = NULL;
-	parser->out_of_memory_flag = 0;
+	parser->document_top = 0;
+	parser->document_string_top = parser->memory.size;
+	parser->edited = 0;
 
-	parser->tmp_token_pos = parser->tmp_value_pos = 0;
-	parser->object_stack_top = -1;
+	rjs_reset_state(parser);
 
-	parser->line_count = 1;
+	return 1;
+}
+
+int rjs_set_flags(rjs_parser_t *parser, int flags){
+	parser->flags = flags;
 
 	return 1;
 }
 
-int rjs_parse_string(rjs_parser_t *parser, const char *str){
-	rjs_size_t index = 0;
+int rjs_set_stats(rjs_parser_t *parser, rjs_parse_stats_t *stats){
+	parser->stats = stats;
 
-	rjs_clean_parser(parser);
+	return 1;
+}
 
-	parser->start_object = rjs_create_obj(parser);
-	rjs_stack_pushobject(parser, parser->start_object);
+int rjs_set_filter(rjs_parser_t *parser, const rjs_predicate_t *predicates, int n, int depth){
+	if(n < 0 || n > RJS_MAX_PREDICATES || depth < 1)
+		return 0;
 
-	parser->state = RJS_SEARCH_OPEN_BRACKET;
-	parser->next_state = RJS_SEARCH_OPEN_BRACKET;
-	return rjs_parse_object(parser, str, &index);
+	parser->filters = predicates;
+	parser->filter_count = n;
+	parser->filter_depth = depth;
+
+	return 1;
 }
 
-const char * rjs_get_error(rjs_parser_t *parser){
-	return parser->error_log;
+rjs_size_t rjs_get_rejected(rjs_parser_t *parser){
+	return parser->filter_rejected;
 }
 
-const rjs_object_t * rjs_get_main_object(rjs_parser_t *parser){
-	return parser->start_object;
+int rjs_parse_string(rjs_parser_t *parser, const char *str){
+	if(!rjs_parse_begin(parser, str))
+		return 0;
+
+	return rjs_parse_step_budget(parser, (rjs_size_t) -1) == RJS_PARSE_DONE;
 }
 
-const rjs_key_t * rjs_get_key(const rjs_object_t *object, const char *name){
-	rjs_key_t *key;
+int rjs_parse_begin(rjs_parser_t *parser, const char *str){
+	rjs_clean_parser(parser);
 
-	if(object->start_key == NULL)
-		return NULL;
+	return rjs_begin_document(parser, str);
+}
 
-	for(key = object->start_key; key != NULL; key = key->next){
-		if(rjs_strcmp(key->name, name) == 0){
-			return key;
-		}
+int rjs_parse_step_budget(rjs_parser_t *parser, rjs_size_t max_bytes){
+#ifdef RJS_CYCLES
+	unsigned long start = RJS_CYCLES();
+#endif
+
+	if(parser->status != RJS_PARSE_IN_PROGRESS)
+		return parser->status;
+
+	parser->status = rjs_parse_object(parser, max_bytes);
+
+#ifdef RJS_CYCLES
+	RJS_STAT_ADD(parser, cycles_total, RJS_CYCLES() - start);
+
+	/* O objeto principal é alocado antes da primeira etapa, fora de
+	 * cycles_total, então a soma das partes pode passar do total. */
+	if(parser->stats != NULL){
+		unsigned long parts = parser->stats->cycles_number + parser->stats->cycles_alloc;
+
+		parser->stats->cycles_tokenize = parser->stats->cycles_total > parts ? parser->stats->cycles_total - parts : 0;
 	}
+#endif
 
-	return NULL;
+	if(parser->status != RJS_PARSE_IN_PROGRESS){
+		parser->filter_element = NULL;
+		RJS_STAT_ADD(parser, bytes, parser->input_index);
+		RJS_PROBE3(parse_end, parser, parser->status, parser->input_index);
+	}
+
+	return parser->status;
 }
 
-const rjs_key_t * rjs_get_key_index(const rjs_object_t *object, rjs_size_t pos){
-	rjs_key_t *key;
+const rjs_object_t * rjs_parse_document(rjs_parser_t *parser, const char *str){
+	rjs_mark_t mark;
 
-	if(object->start_key == NULL)
+	if(!rjs_mark(parser, &mark))
 		return NULL;
 
-	for(key = object->start_key; key != NULL; key = key->next){
-		if(pos == 0) break;
-		pos--;
+	rjs_reset_state(parser);
+
+	if(!rjs_begin_document(parser, str) || rjs_parse_step_budget(parser, (rjs_size_t) -1) != RJS_PARSE_DONE){
+		rjs_rollback(parser, &mark);
+		return NULL;
 	}
 
-	return key;
+	return parser->start_object;
 }
 
-int rjs_istype(const rjs_key_t *key, int type){
-	if(key == NULL) return 0;
+int rjs_mark(rjs_parser_t *parser, rjs_mark_t *mark){
+	if(parser->status == RJS_PARSE_IN_PROGRESS)
+		return 0;
 
-	return key->value.type == type;
-}
+	mark->top = parser->memory.top;
+	mark->string_top = parser->memory.string_top;
+	mark->start_object = parser->start_object;
+	mark->status = parser->status;
+	mark->document_top = parser->document_top;
+	mark->document_string_top = parser->document_string_top;
+	mark->edited = parser->edited;
 
-int rjs_isvalid(const void *key){
-	return key != NULL;
+	return 1;
 }
 
-const rjs_object_t * rjs_get_vobj(const rjs_key_t *key){
-	return key->value.data.obj;
-}
+int rjs_rollback(rjs_parser_t *parser, const rjs_mark_t *mark){
+	if(mark->top > parser->memory.top || mark->string_top < parser->memory.string_top)
+		return 0;
 
-const char * rjs_get_vstring(const rjs_key_t *key){
-	return key->value.data.str;
-}
+	parser->memory.top = mark->top;
+	parser->memory.string_top = mark->string_top;
+	parser->start_object = mark->start_object;
+	parser->status = mark->status;
+	parser->document_top = mark->document_top;
+	parser->document_string_top = mark->document_string_top;
+	parser->edited = mark->edited;
 
-double rjs_get_vnumber(const rjs_key_t *key){
-	return key->value.data.number;
-}
+	parser->object_stack_top = -1;
+	parser->generation++;
 
-int rjs_get_vbool(const rjs_key_t *key){
-	return key->value.data.r_bool;
+	return 1;
 }
 
-const char * rjs_get_typename(const rjs_key_t *key){
-	return names[key->value.type];
+rjs_size_t rjs_compact_size(rjs_parser_t *parser){
+	rjs_count_t count = {0, 0, 0, 0};
+
+	if(parser->start_object == NULL)
+		return 0;
+
+	rjs_count_object(parser->start_object, &count);
+
+	return rjs_align_size(count.objects * sizeof(rjs_object_t))
+		+ rjs_align_size(count.keys * sizeof(rjs_key_t))
+		+ count.numbers * sizeof(double)
+		+ count.chars;
 }
 
-static void rjs_log(rjs_parser_t *parser, const char *message){
-	const char *line = " Line: ";
-	rjs_size_t pos = 0;
-	int line_count = parser->line_count;
-	int div_10 = 100000;
-	int found_number = 0;
+const rjs_object_t * rjs_compact(rjs_parser_t *parser, char *block, rjs_size_t size){
+	rjs_count_t count = {0, 0, 0, 0};
+	rjs_object_t *objects;
+	rjs_key_t *keys;
+	double *numbers;
+	char *strings;
+	rjs_size_t object_count = 1;
+	rjs_size_t scan;
 
-	while(*message != '\0'){
-		parser->error_log[pos++] = *(message++);
+	if(parser->start_object == NULL || block == NULL)
+		return NULL;
 
-		if(pos == RJS_MAX_STRING_SIZE - 1)
-			break;
-	}
+	if(size < rjs_compact_size(parser))
+		return NULL;
 
-	while(*line != '\0'){
-		parser->error_log[pos++] = *(line++);
+	rjs_count_object(parser->start_object, &count);
 
-		if(pos == RJS_MAX_STRING_SIZE - 1)
-			break;
-	}
-	
-	while(div_10 != 0){
-		char c = '0' + (char) (line_count / div_10);
+	objects = (rjs_object_t *) block;
+	keys = (rjs_key_t *) (block + rjs_align_size(count.objects * sizeof(rjs_object_t)));
+	numbers = (double *) ((char *) keys + rjs_align_size(count.keys * sizeof(rjs_key_t)));
+	strings = (char *) (numbers + count.numbers);
 
-		if(c != '0' || found_number){
-			parser->error_log[pos++] = '0' + (char) (line_count / div_10);
-			found_number = 1;
+	/* Cópia em largura: os objetos já copiados servem de fila, e as chaves
+	 * de cada objeto são copiadas juntas quando ele é visitado. */
+	objects[0] = *parser->start_object;
+
+	for(scan = 0; scan < object_count; scan++){
+		rjs_object_t *object = &objects[scan];
+		const rjs_key_t *key = object->start_key;
+
+		if(object->numbers != NULL){
+			rjs_size_t i;
+
+			for(i = 0; i < object->length; i++)
+				numbers[i] = object->numbers[i];
+
+			object->numbers = numbers;
+			numbers += object->length;
 		}
 
-		line_count %= div_10;
-		div_10 /= 10;
+		object->start_key = object->end_key = NULL;
 
-		if(pos == RJS_MAX_STRING_SIZE - 1)
-			break;
+		for(; key != NULL; key = key->next){
+			rjs_key_t *new_key = keys++;
+
+			*new_key = *key;
+			new_key->next = NULL;
+			new_key->name = rjs_copy_string(&strings, key->name);
+
+			if(key->value.type == RJS_KEY_STRING){
+				new_key->value.data.str = rjs_copy_string(&strings, key->value.data.str);
+			}
+			else if(key->value.type == RJS_KEY_NUMBER && key->value.is_lazy){
+				new_key->value.data.number = rjs_get_vnumber(key);
+				new_key->value.is_lazy = 0;
+			}
+			else if(key->value.type == RJS_KEY_OBJECT){
+				objects[object_count] = *key->value.data.obj;
+				new_key->value.data.obj = &objects[object_count++];
+			}
+
+			if(object->start_key == NULL)
+				object->start_key = new_key;
+			else
+				object->end_key->next = new_key;
+
+			object->end_key = new_key;
+		}
 	}
 
-	parser->error_log[pos] = '\0';
+	return objects;
 }
 
-static int rjs_add_character(char *str, rjs_size_t pos, char ch){
-	if(pos >= RJS_MAX_STRING_SIZE - 1){
-		str[RJS_MAX_STRING_SIZE - 1] = '\0';
+const rjs_object_t * rjs_new_object(rjs_parser_t *parser, int is_array){
+	rjs_object_t *object = rjs_create_obj(parser);
+
+	if(object == NULL){
+		parser->out_of_memory_flag = 0;
+		return NULL;
+	}
+
+	object->is_array = is_array;
+	parser->edited = 1;
+
+	return object;
+}
+
+int rjs_set_number(rjs_parser_t *parser, const rjs_key_t *key, double number){
+	rjs_key_t *edit = (rjs_key_t *) key;
+
+	if(key == NULL)
+		return 0;
+
+	/* Os caminhos dentro de um objeto substituído deixam de existir. */
+	if(key->value.type == RJS_KEY_OBJECT)
+		parser->generation++;
+
+	parser->edited = 1;
+	edit->value.type = RJS_KEY_NUMBER;
+	edit->value.data.number = number;
+	edit->value.is_lazy = 0;
+
+	return 1;
+}
+
+int rjs_set_string(rjs_parser_t *parser, const rjs_key_t *key, const char *str){
+	rjs_key_t *edit = (rjs_key_t *) key;
+	const char *location;
+
+	if(key == NULL || str == NULL)
+		return 0;
+
+	location = rjs_pushstring(parser, str);
+
+	if(location == NULL){
+		parser->out_of_memory_flag = 0;
 		return 0;
 	}
-	
-	str[pos] = ch;
+
+	if(key->value.type == RJS_KEY_OBJECT)
+		parser->generation++;
+
+	parser->edited = 1;
+	edit->value.type = RJS_KEY_STRING;
+	edit->value.data.str = location;
+	edit->value.is_lazy = 0;
 
 	return 1;
 }
 
-static int rjs_isspace(char c){
-	if(c == ' ' || c == '\n' || c == '\t' || c == '\r')
-		return 1;
+int rjs_set_bool(rjs_parser_t *parser, const rjs_key_t *key, int value){
+	rjs_key_t *edit = (rjs_key_t *) key;
 
-	return 0;
+	if(key == NULL)
+		return 0;
+
+	if(key->value.type == RJS_KEY_OBJECT)
+		parser->generation++;
+
+	parser->edited = 1;
+	edit->value.type = RJS_KEY_BOOLEAN;
+	edit->value.data.r_bool = value;
+	edit->value.is_lazy = 0;
+
+	return 1;
 }
 
-static int rjs_isstartnumber(char c){
-	if((c >= '0' && c <= '9') || c == '-')
-		return 1;
+int rjs_set_null(rjs_parser_t *parser, const rjs_key_t *key){
+	rjs_key_t *edit = (rjs_key_t *) key;
 
-	return 0;
+	if(key == NULL)
+		return 0;
+
+	if(key->value.type == RJS_KEY_OBJECT)
+		parser->generation++;
+
+	parser->edited = 1;
+	edit->value.type = RJS_KEY_NULL;
+	edit->value.is_lazy = 0;
+
+	return 1;
 }
 
-static double rjs_pow(double number, int exponent){
-	double result;
+int rjs_set_object(rjs_parser_t *parser, const rjs_key_t *key, const rjs_object_t *object){
+	rjs_key_t *edit = (rjs_key_t *) key;
 
-	switch(exponent){
-		case 0:
-			return 1;
-			break;
+	if(key == NULL || object == NULL)
+		return 0;
 
-		case 1:
-			return number;
-			break;
-			
-		case -1:
-			return 1.0 / number;
-			break;
-	}
+	parser->generation++;
 
-	if(exponent < 0){
-		number = 1.0 / number;
-		exponent = -exponent;
-	}
+	parser->edited = 1;
+	edit->value.type = RJS_KEY_OBJECT;
+	edit->value.data.obj = object;
+	edit->value.is_lazy = 0;
+
+	return 1;
+}
 
-	result = 1.0;
+const rjs_key_t * rjs_insert_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name){
+	if(object == NULL || (!object->is_array && name == NULL))
+		return NULL;
 
-	while(exponent != 0){
-		if(exponent % 2 == 1){
-			result = result * number;
-		}
+	if(!object->is_array){
+		const rjs_key_t *found = rjs_get_key(object, name);
 
-		number *= number;
-		
-		exponent /= 2;
+		if(found != NULL)
+			return found;
 	}
 
-	return result;
+	return rjs_append_key(parser, object, name);
 }
 
-static int rjs_strtod(const char *str, double *ret_number){
-	rjs_size_t pos = 0;
-	int state = RJS_STRTOD_READ_NUMBER;
-	int is_negative = 1;
-	double number = 0;
-	double fraction = 0;
-	double counter_fraction = 1;
-	int exponent = 1;
-	int is_negative_exponent = 1;
+const rjs_key_t * rjs_append_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name){
+	rjs_object_t *edit = (rjs_object_t *) object;
+	rjs_key_t *key;
 
-	if(str[0] == '\0') return 0;
-	if(str[0] == '0' && (str[1] >= '0' && str[1] <= '9')) return 0;
+	if(object == NULL || (!object->is_array && name == NULL))
+		return NULL;
 
-	if(str[0] == '-'){
-		pos++;
-		is_negative = -1;
+	if(object->numbers != NULL && !rjs_unpack_numbers(parser, edit))
+		return NULL;
+
+	key = rjs_alloc_key(parser, edit, name, RJS_KEY_NULL);
+
+	if(key == NULL || (!object->is_array && key->name == NULL)){
+		parser->out_of_memory_flag = 0;
+		return NULL;
 	}
 
-	while(str[pos] != '\0'){
-		switch(state){
-			case RJS_STRTOD_READ_NUMBER:
-				if(str[pos] >= '0' && str[pos] <= '9'){
-					number = (str[pos] - '0') + number * 10;
-				}
-				else if(str[pos] == '.'){
-					state = RJS_STRTOD_READ_FRACTION;
-				}
-				else if(str[pos] == 'e' || str[pos] == 'E'){
-					state = RJS_STRTOD_READ_EXPONENT;
-					exponent = 0;
-				}
-				else{
-					return 0;
-				}
+	rjs_obj_pushkey(parser, edit, key);
+	parser->generation++;
+	parser->edited = 1;
 
-				break;
+	return key;
+}
 
-			case RJS_STRTOD_READ_FRACTION:
-				if(str[pos] >= '0' && str[pos] <= '9'){
-					fraction = (str[pos] - '0') + fraction * 10;
-					counter_fraction /= 10;
-				}
-				else if(str[pos] == 'e' || str[pos] == 'E'){
-					state = RJS_STRTOD_READ_EXPONENT;
-					exponent = 0;
-				}
-				else{
-					return 0;
-				}
+int rjs_remove_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name){
+	rjs_object_t *edit = (rjs_object_t *) object;
+	rjs_key_t *previous = NULL;
+	rjs_key_t *key;
 
-				break;
+	if(object == NULL || name == NULL || object->is_array)
+		return 0;
 
-			case RJS_STRTOD_READ_EXPONENT:
-				if(str[pos] == '-'){
-					is_negative_exponent = -1;
-				}
-				else if(str[pos] >= '0' && str[pos] <= '9'){
-					exponent = (str[pos] - '0') + exponent * 10;
-				}
-				else{
-					return 0;
-				}
+	for(key = edit->start_key; key != NULL; key = key->next){
+		if(rjs_strcmp(key->name, name) == 0){
+			rjs_obj_removekey(edit, previous, key);
+			parser->generation++;
+			parser->edited = 1;
+			return 1;
+		}
+
+		previous = key;
+	}
+
+	return 0;
+}
+
+int rjs_remove_index(rjs_parser_t *parser, const rjs_object_t *object, rjs_size_t pos){
+	rjs_object_t *edit = (rjs_object_t *) object;
+	rjs_key_t *previous = NULL;
+	rjs_key_t *key;
+
+	if(object == NULL || pos >= object->length)
+		return 0;
+
+	if(object->numbers != NULL && !rjs_unpack_numbers(parser, edit))
+		return 0;
+
+	for(key = edit->start_key; pos != 0; key = key->next){
+		previous = key;
+		pos--;
+	}
+
+	rjs_obj_removekey(edit, previous, key);
+	parser->generation++;
+	parser->edited = 1;
+
+	return 1;
+}
+
+int rjs_reparse(rjs_parser_t *parser, const char *str, rjs_size_t start, rjs_size_t removed, rjs_size_t inserted){
+	rjs_object_t *path[RJS_OBJECT_STACK_SIZE];
+	rjs_key_t *path_keys[RJS_OBJECT_STACK_SIZE];
+	rjs_object_t *target, *region;
+	rjs_size_t base, new_size;
+	int depth = 0;
+	int i;
+
+	/* Com um filtro, uma edição pode mudar quais elementos são mantidos,
+	 * edições feitas com as funções de edição estariam em todo o resto do
+	 * documento e números preguiçosos fora da edição apontariam para o texto
+	 * anterior. */
+	if(parser->start_object == NULL || parser->status != RJS_PARSE_DONE || parser->filter_count != 0 || parser->edited
+			|| (parser->flags & RJS_FLAG_LAZY_NUMBERS))
+		return rjs_parse_again(parser, str);
+
+	target = parser->start_object;
+	base = target->offset;
+
+	/* Desce até o menor objeto cujo conteúdo contém toda a edição, sem
+	 * tocar nos seus colchetes. */
+	for(;;){
+		rjs_object_t *child = NULL;
+		rjs_key_t *key;
+
+		for(key = target->start_key; key != NULL; key = key->next){
+			rjs_object_t *obj;
+
+			if(key->value.type != RJS_KEY_OBJECT)
+				continue;
+
+			obj = (rjs_object_t *) key->value.data.obj;
+
+			if(base + obj->offset >= start + removed)
+				break;
 
+			if(obj->size != 0 && base + obj->offset < start && start + removed < base + obj->offset + obj->size){
+				child = obj;
 				break;
+			}
 		}
 
-		pos++;
+		if(child == NULL || depth == RJS_OBJECT_STACK_SIZE)
+			break;
+
+		path[depth] = target;
+		path_keys[depth] = key;
+		depth++;
+
+		base += child->offset;
+		target = child;
 	}
 
-	*ret_number = (number + counter_fraction * fraction) * (is_negative);
+	/* Ler o objeto principal de novo é o mesmo que ler o documento todo. */
+	if(depth == 0)
+		return rjs_parse_again(parser, str);
+
+	new_size = target->size + inserted - removed;
+	region = rjs_parse_region(parser, str, base, target->is_array);
+
+	if(region == NULL || region->size != new_size)
+		return rjs_parse_again(parser, str);
 
-	if(exponent != 1){
-		*ret_number = rjs_pow(*ret_number, exponent * is_negative_exponent);
+	parser->generation++;
+
+	target->start_key = region->start_key;
+	target->end_key = region->end_key;
+	target->length = region->length;
+	target->numbers = region->numbers;
+	target->size = new_size;
+
+	/* Os objetos que vêm depois da edição em cada pai andam junto com ela. */
+	for(i = depth - 1; i >= 0; i--){
+		rjs_key_t *key;
+
+		for(key = path_keys[i]->next; key != NULL; key = key->next){
+			if(key->value.type == RJS_KEY_OBJECT){
+				rjs_object_t *obj = (rjs_object_t *) key->value.data.obj;
+				obj->offset = obj->offset + inserted - removed;
+			}
+		}
+
+		path[i]->size = path[i]->size + inserted - removed;
 	}
-	
+
 	return 1;
 }
 
-static int rjs_strncmp(const char *str1, const char *str2, rjs_size_t n){
-	while(n-- != 0){
-		if(*str1 != *str2)
-			return *str1 - *str2;
+rjs_size_t rjs_index_size(rjs_parser_t *parser, rjs_size_t *keys){
+	rjs_count_t count = {0, 0, 0, 0};
 
-		str1++;
-		str2++;
+	*keys = 0;
+
+	if(parser->start_object == NULL)
+		return 0;
+
+	rjs_count_object(parser->start_object, &count);
+	*keys = count.keys;
+
+	/* A tabela pode precisar de alinhamento. */
+	return rjs_index_capacity(count.keys) * sizeof(rjs_path_entry_t) + RJS_ALIGNMENT;
+}
+
+int rjs_build_index(rjs_parser_t *parser, rjs_path_index_t *index){
+	rjs_count_t count = {0, 0, 0, 0};
+	rjs_size_t i;
+
+	if(parser->start_object == NULL || parser->status != RJS_PARSE_DONE)
+		return 0;
+
+	rjs_count_object(parser->start_object, &count);
+
+	index->capacity = rjs_index_capacity(count.keys);
+	index->entries = (rjs_path_entry_t *) rjs_alloc(parser, index->capacity * sizeof(rjs_path_entry_t));
+
+	if(index->entries == NULL){
+		parser->out_of_memory_flag = 0;
+		return 0;
 	}
 
-	return 0;
+	for(i = 0; i < index->capacity; i++)
+		index->entries[i].key = NULL;
+
+	index->parser = parser;
+	index->generation = parser->generation;
+	index->count = 0;
+	index->bytes = index->capacity * sizeof(rjs_path_entry_t);
+
+	rjs_index_object(index, parser->start_object, 0, RJS_HASH_BASIS);
+
+	return 1;
 }
 
-static int rjs_strcmp(const char *str1, const char *str2){
-	while(*(str1) == *(str2)){
-		if(*str1 == '\0')
+const rjs_key_t * rjs_index_get(const rjs_path_index_t *index, const char *path){
+	rjs_size_t hash = RJS_HASH_BASIS;
+	rjs_size_t mask = index->capacity - 1;
+	const char *end;
+	rjs_size_t slot;
+
+	if(index->generation != index->parser->generation)
+		return rjs_get_path(index->parser->start_object, path);
+
+	if(path == NULL || *path != '/')
+		return NULL;
+
+	for(end = path; *end == '/';){
+		hash = rjs_hash_path(hash, ++end, 1);
+
+		while(*end != '/' && *end != '\0')
+			end++;
+	}
+
+	for(slot = hash & mask; index->entries[slot].key != NULL; slot = (slot + 1) & mask){
+		if(index->entries[slot].hash == hash && rjs_index_match(index, slot, path, end))
+			return index->entries[slot].key;
+	}
+
+	return NULL;
+}
+
+int rjs_index_valid(const rjs_path_index_t *index){
+	return index->parser != NULL && index->generation == index->parser->generation;
+}
+
+rjs_size_t rjs_read_number(const char *str, double *number){
+	char buffer[RJS_MAX_STRING_SIZE];
+	rjs_size_t length = 0;
+
+	while(str[length] != '\0' && !rjs_isspace(str[length]) && str[length] != ','
+			&& str[length] != '}' && str[length] != ']'){
+		if(length == RJS_MAX_STRING_SIZE - 1)
 			return 0;
 
-		str1++;
-		str2++;
+		buffer[length] = str[length];
+		length++;
 	}
 
-	return *str1 - *str2;
+	buffer[length] = '\0';
+
+	if(length == 0 || !rjs_strtod(buffer, number))
+		return 0;
+
+	return length;
 }
 
-static void *rjs_alloc(rjs_parser_t *parser, rjs_size_t size){
-	void *location;
+const char * rjs_get_error(rjs_parser_t *parser){
+	return parser->error_log;
+}
 
-	if(parser->memory.top + size > parser->memory.size){
-		parser->out_of_memory_flag = 1;
+const rjs_error_t * rjs_get_error_info(rjs_parser_t *parser){
+	return &parser->error;
+}
+
+const rjs_object_t * rjs_get_main_object(rjs_parser_t *parser){
+	return parser->start_object;
+}
+
+const rjs_key_t * rjs_get_key(const rjs_object_t *object, const char *name){
+	rjs_key_t *key;
+
+	if(object->start_key == NULL)
 		return NULL;
+
+	for(key = object->start_key; key != NULL; key = key->next){
+		if(rjs_strcmp(key->name, name) == 0){
+			return key;
+		}
 	}
 
-	location = (void *) (parser->memory.block + parser->memory.top);
-	parser->memory.top += size;
+	return NULL;
+}
 
-	return location;
+rjs_size_t rjs_get_keys(const rjs_object_t *object, const char * const *names, rjs_size_t n, const rjs_key_t **keys){
+	unsigned char chain[RJS_KEYS_BATCH];
+	unsigned char heads[RJS_KEYS_BUCKETS];
+	rjs_size_t found = 0;
+	rjs_size_t first, i;
+
+	for(i = 0; i < n; i++)
+		keys[i] = NULL;
+
+	if(object == NULL || object->is_array)
+		return 0;
+
+	/* Os nomes são buscados em grupos, com um percurso para cada grupo. */
+	for(first = 0; first < n; first += RJS_KEYS_BATCH){
+		const char * const *group = names + first;
+		const rjs_key_t **group_keys = keys + first;
+		rjs_size_t count = n - first < RJS_KEYS_BATCH ? n - first : RJS_KEYS_BATCH;
+		rjs_size_t remaining = count;
+		rjs_key_t *key;
+
+		/* Os nomes são separados pelo primeiro caractere, para que cada
+		 * chave só seja comparada com os nomes que começam como ela. Os
+		 * índices são guardados somados de 1, com 0 marcando o fim. */
+		for(i = 0; i < RJS_KEYS_BUCKETS; i++)
+			heads[i] = 0;
+
+		for(i = count; i > 0; i--){
+			unsigned char bucket = (unsigned char) group[i - 1][0] % RJS_KEYS_BUCKETS;
+
+			chain[i - 1] = heads[bucket];
+			heads[bucket] = (unsigned char) i;
+		}
+
+		for(key = object->start_key; key != NULL && remaining != 0; key = key->next){
+			unsigned char j = heads[(unsigned char) key->name[0] % RJS_KEYS_BUCKETS];
+
+			for(; j != 0; j = chain[j - 1]){
+				i = j - 1;
+
+				/* Nomes diferentes podem cair no mesmo grupo. */
+				if(group[i][0] != key->name[0] || group_keys[i] != NULL)
+					continue;
+
+				if(rjs_strcmp(key->name, group[i]) == 0){
+					group_keys[i] = key;
+					remaining--;
+				}
+			}
+		}
+
+		found += count - remaining;
+	}
+
+	return found;
 }
 
-static const char *rjs_pushstring(rjs_parser_t *parser, const char *str){
-	char *location;
-	rjs_size_t size = 0;
+const rjs_key_t * rjs_get_key_from(const rjs_object_t *object, const rjs_key_t **cursor, const char *name){
+	const rjs_key_t *start, *key;
 
-	if(str == NULL)
+	if(object == NULL || object->is_array || object->start_key == NULL)
 		return NULL;
 
-	while(str[size++] != '\0');
+	start = (*cursor != NULL) ? *cursor : object->start_key;
+	key = start;
+
+	do{
+		if(rjs_strcmp(key->name, name) == 0){
+			*cursor = (key->next != NULL) ? key->next : object->start_key;
+			return key;
+		}
+
+		key = (key->next != NULL) ? key->next : object->start_key;
+	}while(key != start);
+
+	return NULL;
+}
+
+const rjs_key_t * rjs_get_key_index(const rjs_object_t *object, rjs_size_t pos){
+	rjs_key_t *key;
+
+	if(object->start_key == NULL)
+		return NULL;
+
+	for(key = object->start_key; key != NULL; key = key->next){
+		if(pos == 0) break;
+		pos--;
+	}
+
+	return key;
+}
+
+const rjs_key_t * rjs_get_path(const rjs_object_t *object, const char *path){
+	const rjs_key_t *key = NULL;
+
+	if(object == NULL || path == NULL || *path != '/')
+		return NULL;
+
+	while(*(path++) == '/'){
+		if(key != NULL){
+			if(key->value.type != RJS_KEY_OBJECT)
+				return NULL;
+
+			object = key->value.data.obj;
+		}
+
+		if(object->is_array){
+			rjs_size_t position;
+
+			if(!rjs_path_position(path, &position))
+				return NULL;
+
+			key = rjs_get_key_index(object, position);
+		}
+		else{
+			for(key = object->start_key; key != NULL; key = key->next){
+				if(rjs_path_match(path, key->name))
+					break;
+			}
+		}
+
+		if(key == NULL)
+			return NULL;
+
+		while(*path != '/' && *path != '\0')
+			path++;
+	}
+
+	return key;
+}
+
+rjs_size_t rjs_get_length(const rjs_object_t *object){
+	return object->length;
+}
+
+const double * rjs_get_numbers(const rjs_object_t *object, rjs_size_t *length){
+	*length = object->length;
+
+	return object->numbers;
+}
+
+int rjs_istype(const rjs_key_t *key, int type){
+	if(key == NULL) return 0;
+
+	return key->value.type == type;
+}
+
+int rjs_isvalid(const void *key){
+	return key != NULL;
+}
+
+const rjs_object_t * rjs_get_vobj(const rjs_key_t *key){
+	return key->value.data.obj;
+}
+
+const char * rjs_get_vstring(const rjs_key_t *key){
+	return key->value.data.str;
+}
+
+double rjs_get_vnumber(const rjs_key_t *key){
+	if(key->value.is_lazy){
+		double number = 0;
+
+		/* A sintaxe foi verificada na leitura, então a conversão não falha.
+		 * O resultado não é guardado: a chave é const, e o documento pode
+		 * estar sendo lido por outras threads (veja rjs_cache_number). */
+		rjs_read_number(key->value.data.raw, &number);
+
+		return number;
+	}
+
+	return key->value.data.number;
+}
+
+double rjs_cache_number(rjs_parser_t *parser, const rjs_key_t *key){
+	rjs_key_t *edit = (rjs_key_t *) key;
+
+	/* O valor não muda, então o documento continua igual ao texto. */
+	(void) parser;
+
+	if(key->value.is_lazy){
+		edit->value.data.number = rjs_get_vnumber(key);
+		edit->value.is_lazy = 0;
+	}
+
+	return key->value.data.number;
+}
+
+const char * rjs_get_vraw(const rjs_key_t *key, rjs_size_t *length){
+	const char *raw;
+	rjs_size_t i = 0;
+
+	if(key->value.type != RJS_KEY_NUMBER || !key->value.is_lazy)
+		return NULL;
+
+	raw = key->value.data.raw;
+
+	/* O número termina onde terminou na leitura. */
+	while(raw[i] != '\0' && !rjs_isspace(raw[i]) && raw[i] != ',' && raw[i] != '}' && raw[i] != ']')
+		i++;
+
+	if(length != NULL)
+		*length = i;
+
+	return raw;
+}
+
+int rjs_get_vbool(const rjs_key_t *key){
+	return key->value.data.r_bool;
+}
+
+const char * rjs_get_typename(const rjs_key_t *key){
+	return names[key->value.type];
+}
+
+int rjs_extract_columns(const rjs_object_t *array, const char * const *key_names, rjs_size_t n, double * const *columns, rjs_size_t max_rows, rjs_size_t *rows){
+	const rjs_key_t *row;
+	rjs_size_t row_count = 0;
+
+	*rows = 0;
+
+	/* Os elementos de uma array compactada são números. */
+	if(array == NULL || !array->is_array || array->numbers != NULL)
+		return 0;
+
+	for(row = array->start_key; row != NULL; row = row->next){
+		const rjs_object_t *object;
+		const rjs_key_t *cursor = NULL;
+		rjs_size_t i;
+
+		if(!rjs_istype(row, RJS_KEY_OBJECT) || row_count == max_rows)
+			return 0;
+
+		object = rjs_get_vobj(row);
+
+		if(object->is_array)
+			return 0;
+
+		for(i = 0; i < n; i++){
+			const rjs_key_t *key = rjs_get_key_from(object, &cursor, key_names[i]);
+
+			if(key == NULL || !rjs_istype(key, RJS_KEY_NUMBER))
+				return 0;
+
+			columns[i][row_count] = rjs_get_vnumber(key);
+		}
+
+		*rows = ++row_count;
+	}
+
+	return 1;
+}
+
+int rjs_array_to_doubles(const rjs_object_t *array, double *out, rjs_size_t max, rjs_size_t *count){
+	const rjs_key_t *key;
+	rjs_size_t i = 0;
+
+	*count = 0;
+
+	if(array->numbers != NULL){
+		for(; i < array->length && i < max; i++)
+			out[i] = array->numbers[i];
+
+		*count = i;
+
+		return i == array->length;
+	}
+
+	for(key = array->start_key; key != NULL; key = key->next){
+		if(key->value.type != RJS_KEY_NUMBER || i == max){
+			*count = i;
+			return 0;
+		}
+
+		out[i++] = key->value.is_lazy ? rjs_get_vnumber(key) : key->value.data.number;
+	}
+
+	*count = i;
+
+	return 1;
+}
+
+int rjs_array_to_strings(const rjs_object_t *array, const char **out, rjs_size_t max, rjs_size_t *count){
+	const rjs_key_t *key;
+	rjs_size_t i = 0;
+
+	*count = 0;
+
+	/* Uma array compactada só tem números. */
+	if(array->numbers != NULL)
+		return array->length == 0;
+
+	for(key = array->start_key; key != NULL; key = key->next){
+		if(key->value.type != RJS_KEY_STRING || i == max){
+			*count = i;
+			return 0;
+		}
+
+		out[i++] = key->value.data.str;
+	}
+
+	*count = i;
+
+	return 1;
+}
+
+int rjs_reader_create(rjs_reader_t *reader, char *buffer, rjs_size_t size){
+	reader->input = NULL;
+	reader->input_size = reader->input_index = 0;
+	reader->input_end = 0;
+
+	reader->buffer = buffer;
+	reader->buffer_size = buffer != NULL ? size : 0;
+	reader->buffer_pos = 0;
+	reader->copying = 0;
+	reader->segment = 0;
+
+	reader->number_pos = 0;
+	reader->literal = NULL;
+	reader->literal_pos = 0;
+
+	reader->unicode = 0;
+	reader->unicode_digits = 0;
+	reader->high_surrogate = 0;
+
+	reader->depth = 0;
+	reader->state = RJS_EXPECT_ROOT;
+	reader->is_key = 0;
+	reader->last_event = -1;
+
+	reader->skip_depth = reader->skip_string = reader->skip_escape = 0;
+	reader->skip_value = 0;
+
+	reader->line_count = 1;
+	reader->error_log[0] = '\0';
+
+	return 1;
+}
+
+int rjs_reader_feed(rjs_reader_t *reader, const char *chunk, rjs_size_t size){
+	if(reader->input_index < reader->input_size)
+		return 0;
+
+	reader->input = chunk;
+	reader->input_size = size;
+	reader->input_index = 0;
+	reader->segment = 0;
+
+	if(size == 0)
+		reader->input_end = 1;
+
+	return 1;
+}
+
+int rjs_reader_next(rjs_reader_t *reader, rjs_event_t *event){
+	const char *str = reader->input;
+	rjs_size_t size = reader->input_size;
+	rjs_size_t *index = &reader->input_index;
+
+	for(;;){
+		char current;
+
+		if(reader->state == RJS_FINISHED)
+			return RJS_READER_DONE;
+
+		if(reader->state == RJS_FAILED)
+			return RJS_READER_ERROR;
+
+		if(*index >= size){
+			/* A parte da string que está neste pedaço é copiada antes que
+			 * ele seja trocado. */
+			if(reader->state == RJS_IN_STRING && !rjs_reader_flush(reader))
+				return rjs_reader_error(reader, "String too long for the reader buffer.");
+
+			if(reader->input_end)
+				return rjs_reader_error(reader, "Unexpected end of input.");
+
+			return RJS_READER_NEED_INPUT;
+		}
+
+		current = str[*index];
+
+		if(reader->state <= RJS_EXPECT_END && rjs_isspace(current)){
+			if(current == '\n')
+				reader->line_count++;
+
+			(*index)++;
+			continue;
+		}
+
+		switch(reader->state){
+			case RJS_EXPECT_ROOT:
+				if(current != '{' && current != '[')
+					return rjs_reader_error(reader, "Expected open bracket.");
+
+				(*index)++;
+				rjs_reader_push(reader, current == '[');
+				reader->state = current == '[' ? RJS_EXPECT_VALUE : RJS_EXPECT_KEY;
+				rjs_reader_emit(reader, event, current == '[' ? RJS_EVENT_BEGIN_ARRAY : RJS_EVENT_BEGIN_OBJECT);
+
+				return RJS_READER_EVENT;
+
+			case RJS_EXPECT_KEY:
+				if(current == '}')
+					return rjs_reader_close(reader, current, event);
+
+				if(current != '\"')
+					return rjs_reader_error(reader, "Expected quote.");
+
+				(*index)++;
+				reader->is_key = 1;
+				reader->copying = 0;
+				reader->buffer_pos = 0;
+				reader->segment = *index;
+				reader->state = RJS_IN_STRING;
+
+				break;
+
+			case RJS_EXPECT_COLON:
+				if(current != ':')
+					return rjs_reader_error(reader, "Expected colon.");
+
+				(*index)++;
+				reader->state = RJS_EXPECT_VALUE;
+
+				break;
+
+			case RJS_EXPECT_VALUE:
+				/* Objetos, arrays e strings pulados são só percorridos. */
+				if(reader->skip_value && (current == '{' || current == '[' || current == '\"')){
+					(*index)++;
+					reader->skip_value = 0;
+					reader->skip_depth = current != '\"';
+					reader->skip_string = current == '\"';
+					reader->skip_escape = 0;
+					reader->state = RJS_IN_SKIP;
+				}
+				else if(current == '\"'){
+					(*index)++;
+					reader->is_key = 0;
+					reader->copying = 0;
+					reader->buffer_pos = 0;
+					reader->segment = *index;
+					reader->state = RJS_IN_STRING;
+				}
+				else if(rjs_isstartnumber(current)){
+					reader->number_pos = 0;
+					reader->state = RJS_IN_NUMBER;
+				}
+				else if(current == '{' || current == '['){
+					if(!rjs_reader_push(reader, current == '['))
+						return rjs_reader_error(reader, "Maximum depth reached.");
+
+					(*index)++;
+					reader->state = current == '[' ? RJS_EXPECT_VALUE : RJS_EXPECT_KEY;
+					rjs_reader_emit(reader, event, current == '[' ? RJS_EVENT_BEGIN_ARRAY : RJS_EVENT_BEGIN_OBJECT);
+
+					return RJS_READER_EVENT;
+				}
+				else if(current == 't' || current == 'f' || current == 'n'){
+					reader->literal = current == 't' ? "true" : (current == 'f' ? "false" : "null");
+					reader->literal_pos = 0;
+					reader->state = RJS_IN_LITERAL;
+				}
+				else if(current == ']' && reader->is_array[reader->depth - 1]){
+					/* Array vazia, ou vírgula antes do fim, como no parser. */
+					return rjs_reader_close(reader, current, event);
+				}
+				else{
+					return rjs_reader_error(reader, "Expected value: number, array, object, boolean or null.");
+				}
+
+				break;
+
+			case RJS_EXPECT_END:
+				if(current == '}' || current == ']')
+					return rjs_reader_close(reader, current, event);
+
+				if(current != ',')
+					return rjs_reader_error(reader, "Expected close bracket or comma character.");
+
+				(*index)++;
+				reader->state = reader->is_array[reader->depth - 1] ? RJS_EXPECT_VALUE : RJS_EXPECT_KEY;
+
+				break;
+
+			case RJS_IN_STRING:
+				if(reader->high_surrogate != 0 && current != '\\')
+					return rjs_reader_error(reader, "Expected low surrogate.");
+
+				if(current == '\"'){
+					if(reader->copying){
+						if(!rjs_reader_flush(reader))
+							return rjs_reader_error(reader, "String too long for the reader buffer.");
+
+						reader->buffer[reader->buffer_pos] = '\0';
+						event->str = reader->buffer;
+						event->length = reader->buffer_pos;
+					}
+					else{
+						event->str = str + reader->segment;
+						event->length = *index - reader->segment;
+					}
+
+					(*index)++;
+
+					if(reader->is_key){
+						reader->state = RJS_EXPECT_COLON;
+						rjs_reader_emit(reader, event, RJS_EVENT_KEY);
+
+						return RJS_READER_EVENT;
+					}
+
+					reader->state = RJS_EXPECT_END;
+
+					if(rjs_reader_emit(reader, event, RJS_EVENT_STRING))
+						return RJS_READER_EVENT;
+				}
+				else if(current == '\\'){
+					if(!rjs_reader_flush(reader))
+						return rjs_reader_error(reader, "String too long for the reader buffer.");
+
+					(*index)++;
+					reader->state = RJS_IN_STRING_CONTROL;
+				}
+				else{
+					/* Avança até o próximo caractere especial. */
+					while(*index < size && str[*index] != '\"' && str[*index] != '\\')
+						(*index)++;
+				}
+
+				break;
+
+			case RJS_IN_STRING_CONTROL:
+				{
+					char control = '\0';
+
+					if(current == '\"') control = '\"';
+					else if(current == '\\') control = '\\';
+					else if(current == '/') control = '/';
+					else if(current == 'b') control = '\b';
+					else if(current == 'f') control = '\f';
+					else if(current == 'n') control = '\n';
+					else if(current == 'r') control = '\r';
+					else if(current == 't') control = '\t';
+
+					(*index)++;
+
+					if(current == 'u'){
+						reader->unicode = 0;
+						reader->unicode_digits = 0;
+						reader->state = RJS_IN_STRING_UNICODE;
+						break;
+					}
+
+					if(reader->high_surrogate != 0)
+						return rjs_reader_error(reader, "Expected low surrogate.");
+
+					if(control == '\0')
+						return rjs_reader_error(reader, "Expected control character.");
+
+					if(!rjs_reader_copy(reader, &control, 1))
+						return rjs_reader_error(reader, "String too long for the reader buffer.");
+
+					reader->segment = *index;
+					reader->state = RJS_IN_STRING;
+				}
+
+				break;
+
+			case RJS_IN_STRING_UNICODE:
+				{
+					int digit = rjs_hex_digit(current);
+					char bytes[4];
+					int length = 0;
+
+					if(digit == -1)
+						return rjs_reader_error(reader, "Expected hexadecimal digit.");
+
+					(*index)++;
+					reader->unicode = reader->unicode * 16 + (unsigned long) digit;
+
+					if(++reader->unicode_digits < 4)
+						break;
+
+					if(reader->high_surrogate != 0){
+						if(reader->unicode < 0xDC00 || reader->unicode > 0xDFFF)
+							return rjs_reader_error(reader, "Expected low surrogate.");
+
+						length = rjs_encode_utf8(0x10000 + ((reader->high_surrogate - 0xD800) << 10) + (reader->unicode - 0xDC00), bytes);
+						reader->high_surrogate = 0;
+					}
+					else if(reader->unicode >= 0xD800 && reader->unicode <= 0xDBFF){
+						reader->high_surrogate = reader->unicode;
+					}
+					else if(reader->unicode >= 0xDC00 && reader->unicode <= 0xDFFF){
+						return rjs_reader_error(reader, "Unexpected low surrogate.");
+					}
+					else if(reader->unicode == 0){
+						return rjs_reader_error(reader, "Null character in string.");
+					}
+					else{
+						length = rjs_encode_utf8(reader->unicode, bytes);
+					}
+
+					if(!rjs_reader_copy(reader, bytes, (rjs_size_t) length))
+						return rjs_reader_error(reader, "String too long for the reader buffer.");
+
+					reader->segment = *index;
+					reader->state = RJS_IN_STRING;
+				}
+
+				break;
+
+			case RJS_IN_NUMBER:
+				while(*index < size){
+					current = str[*index];
+
+					if(rjs_isspace(current) || current == ',' || current == '}' || current == ']')
+						break;
+
+					if(reader->number_pos >= RJS_MAX_STRING_SIZE - 1)
+						return rjs_reader_error(reader, "Error while parsing number.");
+
+					reader->number[reader->number_pos++] = current;
+					(*index)++;
+				}
+
+				/* O número pode continuar no próximo pedaço. */
+				if(*index >= size)
+					break;
+
+				reader->number[reader->number_pos] = '\0';
+
+				if(!rjs_strtod(reader->number, &event->number))
+					return rjs_reader_error(reader, "Error while parsing number.");
+
+				event->str = reader->number;
+				event->length = (rjs_size_t) reader->number_pos;
+				reader->state = RJS_EXPECT_END;
+
+				if(rjs_reader_emit(reader, event, RJS_EVENT_NUMBER))
+					return RJS_READER_EVENT;
+
+				break;
+
+			case RJS_IN_LITERAL:
+				/* Comparado byte a byte, para que o literal possa estar
+				 * dividido entre dois pedaços. */
+				while(*index < size && reader->literal[reader->literal_pos] != '\0'){
+					if(str[*index] != reader->literal[reader->literal_pos])
+						return rjs_reader_error(reader, "Expected value: number, array, object, boolean or null.");
+
+					(*index)++;
+					reader->literal_pos++;
+				}
+
+				if(reader->literal[reader->literal_pos] != '\0')
+					break;
+
+				event->str = reader->literal;
+				event->length = (rjs_size_t) reader->literal_pos;
+				event->r_bool = reader->literal[0] == 't';
+				reader->state = RJS_EXPECT_END;
+
+				if(rjs_reader_emit(reader, event, reader->literal[0] == 'n' ? RJS_EVENT_NULL : RJS_EVENT_BOOLEAN))
+					return RJS_READER_EVENT;
+
+				break;
+
+			case RJS_IN_SKIP:
+				while(*index < size){
+					if(reader->skip_string){
+						if(reader->skip_escape){
+							reader->skip_escape = 0;
+							(*index)++;
+							continue;
+						}
+
+						/* Dentro de strings, só aspas e barras importam. */
+						while(*index < size && str[*index] != '\"' && str[*index] != '\\')
+							(*index)++;
+
+						if(*index >= size)
+							break;
+
+						if(str[(*index)++] == '\\'){
+							reader->skip_escape = 1;
+							continue;
+						}
+
+						reader->skip_string = 0;
+
+						if(reader->skip_depth == 0)
+							break;
+
+						continue;
+					}
+
+					current = str[(*index)++];
+
+					if(current == '\"'){
+						reader->skip_string = 1;
+					}
+					else if(current == '{' || current == '['){
+						reader->skip_depth++;
+					}
+					else if(current == '}' || current == ']'){
+						if(--reader->skip_depth == 0)
+							break;
+					}
+					else if(current == '\n'){
+						reader->line_count++;
+					}
+				}
+
+				if(reader->skip_depth != 0 || reader->skip_string)
+					break;
+
+				reader->state = reader->depth == 0 ? RJS_FINISHED : RJS_EXPECT_END;
+
+				break;
+		}
+	}
+}
+
+int rjs_reader_skip(rjs_reader_t *reader){
+	if(reader->state == RJS_FINISHED || reader->state == RJS_FAILED)
+		return 0;
+
+	if(reader->last_event == RJS_EVENT_BEGIN_OBJECT || reader->last_event == RJS_EVENT_BEGIN_ARRAY){
+		/* O objeto já foi aberto, então o percurso começa dentro dele. */
+		reader->depth--;
+		reader->skip_depth = 1;
+		reader->skip_string = reader->skip_escape = 0;
+		reader->state = RJS_IN_SKIP;
+		reader->last_event = -1;
+
+		return 1;
+	}
+
+	if(reader->last_event == RJS_EVENT_KEY){
+		reader->skip_value = 1;
+		reader->last_event = -1;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+const char * rjs_reader_get_error(rjs_reader_t *reader){
+	return reader->error_log;
+}
+
+static void rjs_log(rjs_parser_t *parser, int code, const char *expected, const char *message){
+	rjs_error_t *error = &parser->error;
+	rjs_size_t line_start = 0;
+	rjs_size_t i;
+
+	error->code = code;
+	error->offset = parser->input_index;
+	error->line = 1;
+	error->expected = expected;
+
+	for(i = 0; parser->input != NULL && i < error->offset; i++){
+		if(parser->input[i] == '\n'){
+			error->line++;
+			line_start = i + 1;
+		}
+	}
+
+	error->column = error->offset - line_start + 1;
+
+	RJS_PROBE5(error, parser, code, error->offset, error->line, message);
+
+	rjs_write_log(parser->error_log, error->line, message);
+}
+
+static void rjs_write_log(char *log, int line_count, const char *message){
+	const char *line = " Line: ";
+	rjs_size_t pos = 0;
+	int div_10 = 100000;
+	int found_number = 0;
+
+	while(*message != '\0'){
+		log[pos++] = *(message++);
+
+		if(pos == RJS_MAX_STRING_SIZE - 1)
+			break;
+	}
+
+	while(*line != '\0'){
+		log[pos++] = *(line++);
+
+		if(pos == RJS_MAX_STRING_SIZE - 1)
+			break;
+	}
+	
+	while(div_10 != 0){
+		char c = '0' + (char) (line_count / div_10);
+
+		if(c != '0' || found_number){
+			log[pos++] = '0' + (char) (line_count / div_10);
+			found_number = 1;
+		}
+
+		line_count %= div_10;
+		div_10 /= 10;
+
+		if(pos == RJS_MAX_STRING_SIZE - 1)
+			break;
+	}
+
+	log[pos] = '\0';
+}
+
+static int rjs_add_character(char *str, rjs_size_t pos, char ch){
+	if(pos >= RJS_MAX_STRING_SIZE - 1){
+		str[RJS_MAX_STRING_SIZE - 1] = '\0';
+		return 0;
+	}
+	
+	str[pos] = ch;
+
+	return 1;
+}
+
+static void rjs_add_string_character(rjs_parser_t *parser, char ch){
+	if(parser->tmp_value_pos == -1)
+		rjs_add_character(parser->tmp_token, parser->tmp_token_pos++, ch);
+	else
+		rjs_add_character(parser->tmp_value, parser->tmp_value_pos++, ch);
+}
+
+static void rjs_add_codepoint(rjs_parser_t *parser, unsigned long codepoint){
+	char bytes[4];
+	int length = rjs_encode_utf8(codepoint, bytes);
+	int i;
+
+	for(i = 0; i < length; i++)
+		rjs_add_string_character(parser, bytes[i]);
+}
+
+static int rjs_encode_utf8(unsigned long codepoint, char *out){
+	if(codepoint < 0x80){
+		out[0] = (char) codepoint;
+		return 1;
+	}
+
+	if(codepoint < 0x800){
+		out[0] = (char) (0xC0 | (codepoint >> 6));
+		out[1] = (char) (0x80 | (codepoint & 0x3F));
+		return 2;
+	}
+
+	if(codepoint < 0x10000){
+		out[0] = (char) (0xE0 | (codepoint >> 12));
+		out[1] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+		out[2] = (char) (0x80 | (codepoint & 0x3F));
+		return 3;
+	}
+
+	out[0] = (char) (0xF0 | (codepoint >> 18));
+	out[1] = (char) (0x80 | ((codepoint >> 12) & 0x3F));
+	out[2] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+	out[3] = (char) (0x80 | (codepoint & 0x3F));
+	return 4;
+}
+
+static int rjs_hex_digit(char c){
+	if(c >= '0' && c <= '9')
+		return c - '0';
+
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+static int rjs_validate_utf8(rjs_parser_t *parser, unsigned char c){
+	/* Byte de continuação: precisa estar dentro dos limites esperados, que
+	 * excluem codificações longas demais e surrogates. */
+	if(parser->utf8_remaining != 0){
+		if(c < parser->utf8_lower || c > parser->utf8_upper)
+			return 0;
+
+		parser->utf8_remaining--;
+		parser->utf8_lower = 0x80;
+		parser->utf8_upper = 0xBF;
+
+		return 1;
+	}
+
+	parser->utf8_lower = 0x80;
+	parser->utf8_upper = 0xBF;
+
+	if(c >= 0xC2 && c <= 0xDF){
+		parser->utf8_remaining = 1;
+	}
+	else if(c >= 0xE0 && c <= 0xEF){
+		parser->utf8_remaining = 2;
+
+		if(c == 0xE0) parser->utf8_lower = 0xA0;
+		if(c == 0xED) parser->utf8_upper = 0x9F;
+	}
+	else if(c >= 0xF0 && c <= 0xF4){
+		parser->utf8_remaining = 3;
+
+		if(c == 0xF0) parser->utf8_lower = 0x90;
+		if(c == 0xF4) parser->utf8_upper = 0x8F;
+	}
+	else{
+		return 0;
+	}
+
+	return 1;
+}
+
+#if defined(RJS_ENABLE_SIMD) && defined(__SSE2__) && defined(__GNUC__)
+RJS_NO_SANITIZE_ADDRESS static rjs_size_t rjs_scan_plain(const char *str, rjs_size_t index){
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i zero = _mm_setzero_si128();
+
+	/* Os bytes até o alinhamento de 16 são verificados um a um. Uma leitura
+	 * alinhada de 16 bytes nunca atravessa uma página, então pode passar do
+	 * fim da string sem risco, como nas implementações de strlen. Por isso a
+	 * função não é instrumentada pelo AddressSanitizer. */
+	while(((rjs_size_t) (str + index) & 15) != 0){
+		unsigned char c = (unsigned char) str[index];
+
+		if(c == '\"' || c == '\\' || c == '\0' || c >= 0x80)
+			return index;
+
+		index++;
+	}
+
+	for(;;){
+		__m128i chunk = _mm_load_si128((const __m128i *) (str + index));
+		__m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+		int mask;
+
+		special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, zero));
+
+		/* O bit mais alto de cada byte indica um caractere não ASCII. */
+		mask = _mm_movemask_epi8(special) | _mm_movemask_epi8(chunk);
+
+		if(mask != 0)
+			return index + (rjs_size_t) __builtin_ctz((unsigned int) mask);
+
+		index += 16;
+	}
+}
+#else
+static rjs_size_t rjs_scan_plain(const char *str, rjs_size_t index){
+	for(;;){
+		unsigned char c = (unsigned char) str[index];
+
+		if(c == '\"' || c == '\\' || c == '\0' || c >= 0x80)
+			return index;
+
+		index++;
+	}
+}
+#endif
+
+static int rjs_isspace(char c){
+	if(c == ' ' || c == '\n' || c == '\t' || c == '\r')
+		return 1;
+
+	return 0;
+}
+
+static int rjs_isstartnumber(char c){
+	if((c >= '0' && c <= '9') || c == '-')
+		return 1;
+
+	return 0;
+}
+
+static double rjs_pow10(int exponent){
+	static const double powers[9] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+	double result = 1.0;
+	int i;
+
+	/* Acima de 10^308 o resultado já é infinito. */
+	if(exponent > 511)
+		exponent = 511;
+
+	for(i = 0; exponent != 0; i++){
+		if(exponent % 2 == 1)
+			result = result * powers[i];
+
+		exponent /= 2;
+	}
+
+	return result;
+}
+
+static int rjs_strtod(const char *str, double *ret_number){
+	rjs_size_t pos = 0;
+	int state = RJS_STRTOD_READ_NUMBER;
+	int is_negative = 1;
+	double number = 0;
+	double fraction = 0;
+	double counter_fraction = 1;
+	int exponent = 0;
+	int has_exponent = 0;
+	int is_negative_exponent = 1;
+
+	if(str[0] == '\0') return 0;
+	if(str[0] == '0' && (str[1] >= '0' && str[1] <= '9')) return 0;
+
+	if(str[0] == '-'){
+		pos++;
+		is_negative = -1;
+	}
+
+	while(str[pos] != '\0'){
+		switch(state){
+			case RJS_STRTOD_READ_NUMBER:
+				if(str[pos] >= '0' && str[pos] <= '9'){
+					number = (str[pos] - '0') + number * 10;
+				}
+				else if(str[pos] == '.'){
+					state = RJS_STRTOD_READ_FRACTION;
+				}
+				else if(str[pos] == 'e' || str[pos] == 'E'){
+					state = RJS_STRTOD_READ_EXPONENT;
+					has_exponent = 1;
+				}
+				else{
+					return 0;
+				}
+
+				break;
+
+			case RJS_STRTOD_READ_FRACTION:
+				if(str[pos] >= '0' && str[pos] <= '9'){
+					fraction = (str[pos] - '0') + fraction * 10;
+					counter_fraction /= 10;
+				}
+				else if(str[pos] == 'e' || str[pos] == 'E'){
+					state = RJS_STRTOD_READ_EXPONENT;
+					has_exponent = 1;
+				}
+				else{
+					return 0;
+				}
+
+				break;
+
+			case RJS_STRTOD_READ_EXPONENT:
+				if(str[pos] == '-'){
+					is_negative_exponent = -1;
+				}
+				else if(str[pos] == '+'){
+					/* O sinal positivo é opcional. */
+				}
+				else if(str[pos] >= '0' && str[pos] <= '9'){
+					/* Acima disso o resultado já é 0 ou infinito, e a conta
+					 * passaria do maior int. */
+					if(exponent < 100000)
+						exponent = (str[pos] - '0') + exponent * 10;
+				}
+				else{
+					return 0;
+				}
+
+				break;
+		}
+
+		pos++;
+	}
+
+	*ret_number = (number + counter_fraction * fraction) * (is_negative);
+
+	if(has_exponent && *ret_number != 0){
+		if(is_negative_exponent == -1){
+			/* Dividir por 10^e é mais preciso do que multiplicar pelo
+			 * inverso. Abaixo de 10^-308, a divisão é feita em partes, para
+			 * que os números subnormais não virem 0. */
+			while(exponent > 308){
+				*ret_number = *ret_number / 1e308;
+				exponent -= 308;
+			}
+
+			*ret_number = *ret_number / rjs_pow10(exponent);
+		}
+		else{
+			*ret_number = *ret_number * rjs_pow10(exponent);
+		}
+	}
+	
+	return 1;
+}
+
+static int rjs_check_number(const char *str){
+	rjs_size_t pos = 0;
+	int state = RJS_STRTOD_READ_NUMBER;
+
+	if(str[0] == '\0') return 0;
+	if(str[0] == '0' && (str[1] >= '0' && str[1] <= '9')) return 0;
+
+	if(str[0] == '-')
+		pos++;
+
+	for(; str[pos] != '\0'; pos++){
+		char c = str[pos];
+
+		if(c >= '0' && c <= '9')
+			continue;
+
+		if(state == RJS_STRTOD_READ_NUMBER && c == '.')
+			state = RJS_STRTOD_READ_FRACTION;
+		else if(state != RJS_STRTOD_READ_EXPONENT && (c == 'e' || c == 'E'))
+			state = RJS_STRTOD_READ_EXPONENT;
+		else if(state != RJS_STRTOD_READ_EXPONENT || (c != '-' && c != '+'))
+			return 0;
+	}
+
+	return 1;
+}
+
+static int rjs_strncmp(const char *str1, const char *str2, rjs_size_t n){
+	while(n-- != 0){
+		if(*str1 != *str2)
+			return *str1 - *str2;
+
+		str1++;
+		str2++;
+	}
+
+	return 0;
+}
+
+static int rjs_strcmp(const char *str1, const char *str2){
+	while(*(str1) == *(str2)){
+		if(*str1 == '\0')
+			return 0;
+
+		str1++;
+		str2++;
+	}
+
+	return *str1 - *str2;
+}
+
+static rjs_size_t rjs_align_padding(const void *location, rjs_size_t alignment){
+	rjs_size_t address = (rjs_size_t) location;
+
+	return (alignment - address % alignment) % alignment;
+}
+
+static void *rjs_alloc_aligned(rjs_parser_t *parser, rjs_size_t size, rjs_size_t alignment){
+	void *location;
+	rjs_size_t padding = rjs_align_padding(parser->memory.block + parser->memory.top, alignment);
+#ifdef RJS_CYCLES
+	unsigned long start = RJS_CYCLES();
+#endif
+
+	if(parser->memory.top + padding + size > parser->memory.string_top){
+		parser->out_of_memory_flag = 1;
+		RJS_PROBE3(arena_full, parser, size, parser->memory.size);
+		return NULL;
+	}
+
+	location = (void *) (parser->memory.block + parser->memory.top + padding);
+	parser->memory.top += padding + size;
+
+	RJS_STAT_ADD(parser, padding, padding);
+	RJS_STAT_MAX(parser, arena_high_water, parser->memory.top + (parser->memory.size - parser->memory.string_top));
+
+#ifdef RJS_CYCLES
+	RJS_STAT_ADD(parser, cycles_alloc, RJS_CYCLES() - start);
+#endif
+
+	return location;
+}
+
+static void *rjs_alloc(rjs_parser_t *parser, rjs_size_t size){
+	return rjs_alloc_aligned(parser, size, RJS_ALIGNMENT);
+}
+
+static const char *rjs_pushstring(rjs_parser_t *parser, const char *str){
+	char *location;
+	rjs_size_t size = 0;
+#ifdef RJS_CYCLES
+	unsigned long start = RJS_CYCLES();
+#endif
+
+	if(str == NULL)
+		return NULL;
+
+	while(str[size++] != '\0');
+
+	if(parser->memory.string_top - parser->memory.top < size){
+		parser->out_of_memory_flag = 1;
+		RJS_PROBE3(arena_full, parser, size, parser->memory.size);
+		return NULL;
+	}
+
+	parser->memory.string_top -= size;
+	location = parser->memory.block + parser->memory.string_top;
+
+	RJS_STAT_MAX(parser, arena_high_water, parser->memory.top + (parser->memory.size - parser->memory.string_top));
+
+	for(size = 0; str[size] != '\0'; size++)
+		location[size] = str[size];
+
+	location[size] = '\0';
+
+#ifdef RJS_CYCLES
+	RJS_STAT_ADD(parser, cycles_alloc, RJS_CYCLES() - start);
+#endif
+
+	return (const char *) location;
+}
+
+static rjs_object_t *rjs_create_obj(rjs_parser_t *parser){
+	rjs_object_t *object;
+
+	object = (rjs_object_t *) rjs_alloc(parser, sizeof(rjs_object_t));
+
+	if(object == NULL)
+		return NULL;
+
+	object->start_key = object->end_key = NULL;
+	object->is_array = 0;
+	object->length = 0;
+	object->numbers = NULL;
+	object->offset = object->size = 0;
+
+	return object;
+}
+
+static void rjs_pack_numbers(rjs_parser_t *parser, rjs_object_t *obj){
+	rjs_key_t *keys = obj->start_key;
+	rjs_key_t *key;
+	double *numbers;
+	double ahead[3];
+	rjs_size_t i;
+
+	if(obj->length == 0)
+		return;
+
+	for(key = obj->start_key; key != NULL; key = key->next){
+		if(key->value.type != RJS_KEY_NUMBER || key->value.is_lazy)
+			return;
+	}
+
+	/* As chaves precisam ser as últimas alocações, uma após a outra, para
+	 * que a memória possa ser devolvida. Assim, a chave i é keys[i]. */
+	if((char *) (keys + obj->length) != parser->memory.block + parser->memory.top)
+		return;
+
+	/* Os números são escritos por cima das próprias chaves, começando em uma
+	 * linha de cache caso ocupem mais de uma. Como cada número é lido três
+	 * chaves antes de ser escrito, e uma chave é maior que um double, nenhuma
+	 * escrita sobrescreve uma chave ainda não lida. */
+	numbers = (double *) keys;
+
+	if(obj->length * sizeof(double) > RJS_CACHE_LINE){
+		numbers = (double *) ((char *) keys + rjs_align_padding(keys, RJS_CACHE_LINE));
+
+		if((char *) (numbers + obj->length) > parser->memory.block + parser->memory.string_top)
+			numbers = (double *) keys;
+	}
+
+	for(i = 0; i < obj->length && i < 3; i++)
+		ahead[i] = keys[i].value.data.number;
+
+	for(i = 0; i < obj->length; i++){
+		double number = ahead[i % 3];
+
+		if(i + 3 < obj->length)
+			ahead[i % 3] = keys[i + 3].value.data.number;
+
+		numbers[i] = number;
+	}
+
+	parser->memory.top = (rjs_size_t) ((char *) (numbers + obj->length) - parser->memory.block);
+
+	obj->numbers = numbers;
+	obj->start_key = obj->end_key = NULL;
+}
+
+static int rjs_unpack_numbers(rjs_parser_t *parser, rjs_object_t *obj){
+	const double *numbers = obj->numbers;
+	rjs_size_t length = obj->length;
+	rjs_size_t i;
+
+	obj->numbers = NULL;
+	obj->length = 0;
+
+	for(i = 0; i < length; i++){
+		rjs_key_t *key = rjs_alloc_key(parser, obj, NULL, RJS_KEY_NUMBER);
+
+		if(key == NULL){
+			/* Mantém a array compactada, como estava. */
+			parser->out_of_memory_flag = 0;
+			obj->numbers = numbers;
+			obj->length = length;
+			obj->start_key = obj->end_key = NULL;
+			return 0;
+		}
+
+		key->value.data.number = numbers[i];
+		rjs_obj_pushkey(parser, obj, key);
+	}
+
+	return 1;
+}
+
+static void rjs_obj_removekey(rjs_object_t *obj, rjs_key_t *previous, rjs_key_t *key){
+	if(previous == NULL)
+		obj->start_key = key->next;
+	else
+		previous->next = key->next;
+
+	if(obj->end_key == key)
+		obj->end_key = previous;
+
+	obj->length--;
+}
+
+static int rjs_stack_pushobject(rjs_parser_t *parser, rjs_object_t *obj){
+	if(parser->object_stack_top == RJS_OBJECT_STACK_SIZE - 1)
+		return 0;
+
+	parser->object_stack[++parser->object_stack_top] = obj;
+
+	RJS_STAT_MAX(parser, max_depth, parser->object_stack_top + 1);
+	RJS_PROBE4(container_open, parser, parser->object_stack_top, obj->is_array, parser->input_index);
+
+	return 1;
+}
+
+static int rjs_stack_popobject(rjs_parser_t *parser){
+	if(parser->object_stack_top == -1)
+		return 0;
+
+	parser->object_stack_top--;
+
+	return 1;
+}
+
+static void rjs_stack_closeobject(rjs_parser_t *parser, rjs_size_t end){
+	rjs_object_t *obj = rjs_stack_top(parser);
+	rjs_object_t *parent;
+
+	obj->size = end - obj->offset;
+
+	RJS_PROBE4(container_close, parser, parser->object_stack_top, obj->is_array, obj->size);
+
+	rjs_stack_popobject(parser);
+	parent = rjs_stack_top(parser);
+
+	/* Enquanto está na pilha, a posição do pai ainda é absoluta. */
+	if(parent != NULL)
+		obj->offset -= parent->offset;
+}
+
+static rjs_object_t * rjs_stack_top(rjs_parser_t *parser){
+	if(parser->object_stack_top == -1)
+		return NULL;
+
+	return parser->object_stack[parser->object_stack_top];
+}
+
+static int rjs_obj_pushkey(rjs_parser_t *parser, rjs_object_t *obj, rjs_key_t *new_key){
+	(void) parser;
+
+	if(obj->start_key == NULL){
+		obj->start_key = obj->end_key = new_key;
+	}
+	else{
+		obj->end_key->next = new_key;
+		obj->end_key = obj->end_key->next;
+	}
+
+	obj->length++;
+	RJS_STAT_ADD(parser, keys, 1);
+
+	/* Objetos filhos não são comparados, então o elemento é descartado
+	 * ao fim caso um predicado tenha o nome deles. */
+	if(obj == parser->filter_element && new_key->value.type != RJS_KEY_OBJECT)
+		rjs_filter_key(parser, new_key);
+
+	return 1;
+}
+
+static rjs_key_t *rjs_alloc_key(rjs_parser_t *parser, rjs_object_t *obj, const char *key, int type){
+	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
+
+	if(new_key == NULL)
+		return NULL;
+
+	if(obj->is_array)
+		new_key->name = NULL;
+	else
+		new_key->name = rjs_pushstring(parser, key);
+
+	new_key->value.type = type;
+	new_key->value.is_lazy = 0;
+	new_key->next = NULL;
+
+	return new_key;
+}
+
+static int rjs_obj_pushkey_string(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str){
+	rjs_key_t *new_key = rjs_alloc_key(parser, obj, key, RJS_KEY_STRING);
+
+	if(new_key == NULL)
+		return 0;
+
+	new_key->value.data.str = rjs_pushstring(parser, str);
+	RJS_STAT_ADD(parser, strings, 1);
+
+	return rjs_obj_pushkey(parser, obj, new_key);
+}
+
+static int rjs_obj_pushkey_number(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str, const char *raw){
+	rjs_key_t *new_key = rjs_alloc_key(parser, obj, key, RJS_KEY_NUMBER);
+	int success;
+#ifdef RJS_CYCLES
+	unsigned long start = RJS_CYCLES();
+#endif
+
+	if(new_key == NULL)
+		return 0;
+
+	/* No modo preguiçoso, o texto não é copiado: a chave aponta para ele. */
+	if(parser->flags & RJS_FLAG_LAZY_NUMBERS){
+		success = rjs_check_number(str);
+
+		new_key->value.data.raw = raw;
+		new_key->value.is_lazy = 1;
+	}
+	else{
+		success = rjs_strtod(str, &new_key->value.data.number);
+	}
+
+#ifdef RJS_CYCLES
+	RJS_STAT_ADD(parser, cycles_number, RJS_CYCLES() - start);
+#endif
+
+	if(!success)
+		return 0;
+
+	RJS_STAT_ADD(parser, numbers, 1);
+
+	return rjs_obj_pushkey(parser, obj, new_key);
+}
+
+static int rjs_obj_pushkey_obj(rjs_parser_t *parser, rjs_object_t *obj, const char *key, rjs_object_t *new_obj){
+	rjs_key_t *new_key = rjs_alloc_key(parser, obj, key, RJS_KEY_OBJECT);
+
+	if(new_key == NULL)
+		return 0;
+
+	new_key->value.data.obj = new_obj;
+
+	return rjs_obj_pushkey(parser, obj, new_key);
+}
+
+static int rjs_obj_pushkey_bool(rjs_parser_t *parser, rjs_object_t *obj, const char *key, int value){
+	rjs_key_t *new_key = rjs_alloc_key(parser, obj, key, RJS_KEY_BOOLEAN);
+
+	if(new_key == NULL)
+		return 0;
+
+	new_key->value.data.r_bool = value;
+
+	return rjs_obj_pushkey(parser, obj, new_key);
+}
+
+static int rjs_obj_pushkey_null(rjs_parser_t *parser, rjs_object_t *obj, const char *key){
+	rjs_key_t *new_key = rjs_alloc_key(parser, obj, key, RJS_KEY_NULL);
+
+	if(new_key == NULL)
+		return 0;
+
+	return rjs_obj_pushkey(parser, obj, new_key);
+}
+
+static void rjs_filter_begin(rjs_parser_t *parser, rjs_object_t *array, rjs_object_t *obj, rjs_size_t top){
+	parser->filter_element = obj;
+	parser->filter_matched = 0;
+	parser->filter_top = top;
+	parser->filter_string_top = parser->memory.string_top;
+	parser->filter_end_key = array->end_key;
+}
+
+static void rjs_filter_key(rjs_parser_t *parser, const rjs_key_t *key){
+	int i;
+
+	if(key->name == NULL)
+		return;
+
+	for(i = 0; i < parser->filter_count; i++){
+		const rjs_predicate_t *predicate = parser->filters + i;
+
+		if(predicate->name[0] != key->name[0] || rjs_strcmp(predicate->name, key->name) != 0)
+			continue;
+
+		if(!rjs_filter_match(predicate, key)){
+			rjs_filter_reject(parser, 1);
+			return;
+		}
+
+		parser->filter_matched |= 1UL << i;
+	}
+}
+
+static int rjs_filter_match(const rjs_predicate_t *predicate, const rjs_key_t *key){
+	int order = 0;
+
+	if(key->value.type != predicate->type)
+		return 0;
+
+	if(key->value.type == RJS_KEY_STRING){
+		if(key->value.data.str == NULL || predicate->str == NULL)
+			return 0;
+
+		order = rjs_strcmp(key->value.data.str, predicate->str);
+	}
+	else if(key->value.type == RJS_KEY_NUMBER){
+		double number = rjs_get_vnumber(key);
+
+		order = number < predicate->number ? -1 : number > predicate->number;
+	}
+	else if(key->value.type == RJS_KEY_BOOLEAN){
+		order = (key->value.data.r_bool != 0) - (predicate->r_bool != 0);
+	}
+
+	switch(predicate->op){
+		case RJS_FILTER_EQUAL: return order == 0;
+		case RJS_FILTER_NOT_EQUAL: return order != 0;
+		case RJS_FILTER_LESS: return order < 0;
+		case RJS_FILTER_LESS_EQUAL: return order <= 0;
+		case RJS_FILTER_GREATER: return order > 0;
+		case RJS_FILTER_GREATER_EQUAL: return order >= 0;
+	}
+
+	return 0;
+}
+
+static void rjs_filter_close(rjs_parser_t *parser){
+	if(parser->filter_matched == (1UL << parser->filter_count) - 1){
+		parser->filter_element = NULL;
+		rjs_stack_closeobject(parser, parser->input_index);
+	}
+	else{
+		rjs_filter_reject(parser, 0);
+	}
+}
+
+static void rjs_filter_reject(rjs_parser_t *parser, int skip){
+	const char *str = parser->input;
+	rjs_size_t index = parser->input_index;
+	rjs_object_t *array;
+
+	if(skip){
+		int depth = 1;
+
+		/* Só os colchetes fora de strings são contados. Um texto cortado
+		 * deixa o índice no '\0', e a leitura termina com erro. */
+		for(; str[index] != '\0' && depth != 0; index++){
+			char current = str[index];
+
+			if(current == '\"'){
+				for(index++; str[index] != '\"' && str[index] != '\0'; index++){
+					if(str[index] == '\\' && str[index + 1] != '\0')
+						index++;
+				}
+
+				if(str[index] == '\0')
+					break;
+			}
+			else if(current == '{' || current == '['){
+				depth++;
+			}
+			else if(current == '}' || current == ']'){
+				depth--;
+			}
+		}
+
+		parser->input_index = index;
+
+		if(depth != 0)
+			return;
+	}
+
+	RJS_PROBE4(container_close, parser, parser->object_stack_top, 0, index - parser->filter_element->offset);
+
+	rjs_stack_popobject(parser);
+	array = rjs_stack_top(parser);
+
+	array->end_key = parser->filter_end_key;
+	array->length--;
+
+	if(array->end_key == NULL)
+		array->start_key = NULL;
+	else
+		array->end_key->next = NULL;
+
+	parser->memory.top = parser->filter_top;
+	parser->memory.string_top = parser->filter_string_top;
+
+	parser->filter_element = NULL;
+	parser->filter_rejected++;
+	parser->next_state = RJS_SEARCH_END;
+}
+
+static int rjs_path_match(const char *segment, const char *name){
+	if(name == NULL)
+		return 0;
+
+	while(*segment != '/' && *segment != '\0'){
+		char c = *(segment++);
+
+		if(c == '~'){
+			if(*segment == '0')
+				c = '~';
+			else if(*segment == '1')
+				c = '/';
+			else
+				return 0;
+
+			segment++;
+		}
+
+		if(*(name++) != c)
+			return 0;
+	}
+
+	return *name == '\0';
+}
+
+static int rjs_path_position(const char *segment, rjs_size_t *position){
+	const char *start = segment;
+
+	*position = 0;
+
+	for(; *segment >= '0' && *segment <= '9'; segment++)
+		*position = *position * 10 + (rjs_size_t) (*segment - '0');
+
+	if(segment == start || (*start == '0' && segment - start > 1))
+		return 0;
+
+	return *segment == '/' || *segment == '\0';
+}
+
+static rjs_size_t rjs_hash_path(rjs_size_t hash, const char *str, int decode){
+	hash = (hash ^ (unsigned char) '/') * RJS_HASH_PRIME;
+
+	for(; *str != '\0' && !(decode && *str == '/'); str++){
+		char c = *str;
+
+		if(decode && c == '~' && (str[1] == '0' || str[1] == '1'))
+			c = *(++str) == '0' ? '~' : '/';
+
+		hash = (hash ^ (unsigned char) c) * RJS_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+static rjs_size_t rjs_index_capacity(rjs_size_t keys){
+	rjs_size_t capacity = 8;
+
+	/* No máximo metade das posições é usada, para que a maioria das buscas
+	 * encontre a chave na primeira posição. */
+	while(capacity < keys * 2)
+		capacity *= 2;
+
+	return capacity;
+}
+
+static void rjs_index_object(rjs_path_index_t *index, const rjs_object_t *object, rjs_size_t parent, rjs_size_t hash){
+	rjs_size_t mask = index->capacity - 1;
+	rjs_size_t position = 0;
+	const rjs_key_t *key;
+
+	for(key = object->start_key; key != NULL; key = key->next, position++){
+		rjs_path_entry_t *entry;
+		rjs_size_t key_hash, slot;
+
+		if(object->is_array){
+			/* A posição é escrita em decimal, como aparece no caminho. */
+			char digits[24];
+			rjs_size_t rest = position;
+			int i = 23;
+
+			digits[i] = '\0';
+
+			do{
+				digits[--i] = (char) ('0' + rest % 10);
+				rest /= 10;
+			}while(rest != 0);
+
+			key_hash = rjs_hash_path(hash, digits + i, 0);
+		}
+		else{
+			key_hash = rjs_hash_path(hash, key->name != NULL ? key->name : "", 0);
+		}
+
+		for(slot = key_hash & mask; index->entries[slot].key != NULL; slot = (slot + 1) & mask);
+
+		entry = index->entries + slot;
+		entry->key = key;
+		entry->hash = key_hash;
+		entry->parent = parent;
+		entry->index = position;
+
+		index->count++;
+
+		if(key->value.type == RJS_KEY_OBJECT)
+			rjs_index_object(index, key->value.data.obj, slot + 1, key_hash);
+	}
+}
+
+static int rjs_index_match(const rjs_path_index_t *index, rjs_size_t slot, const char *path, const char *end){
+	for(;;){
+		const rjs_path_entry_t *entry = index->entries + slot;
+		const char *segment = end;
+
+		/* O caminho começa com '/', então sempre há um antes do trecho. */
+		while(*(segment - 1) != '/')
+			segment--;
+
+		if(entry->key->name == NULL){
+			rjs_size_t position;
 
-	/* padding */
-	location = (char *) rjs_alloc(parser, size + 4 - (size % 4));
+			if(!rjs_path_position(segment, &position) || position != entry->index)
+				return 0;
+		}
+		else if(!rjs_path_match(segment, entry->key->name)){
+			return 0;
+		}
 
-	if(location == NULL)
-		return NULL;
+		end = segment - 1;
 
-	for(size = 0; str[size] != '\0'; size++)
-		location[size] = str[size];
+		if(end == path)
+			return entry->parent == 0;
 
-	location[size] = '\0';
+		if(entry->parent == 0)
+			return 0;
 
-	return (const char *) location;
+		slot = entry->parent - 1;
+	}
 }
 
-static rjs_object_t *rjs_create_obj(rjs_parser_t *parser){
-	rjs_object_t *object;
+static rjs_size_t rjs_align_size(rjs_size_t size){
+	return size + (RJS_ALIGNMENT - size % RJS_ALIGNMENT) % RJS_ALIGNMENT;
+}
 
-	object = (rjs_object_t *) rjs_alloc(parser, sizeof(rjs_object_t));
+static void rjs_count_object(const rjs_object_t *object, rjs_count_t *count){
+	const rjs_key_t *key;
 
-	if(object == NULL)
-		return NULL;
+	count->objects++;
 
-	object->start_key = object->end_key = NULL;
-	object->is_array = 0;
+	if(object->numbers != NULL)
+		count->numbers += object->length;
 
-	return object;
-}
+	for(key = object->start_key; key != NULL; key = key->next){
+		count->keys++;
 
-static int rjs_stack_pushobject(rjs_parser_t *parser, rjs_object_t *obj){
-	if(parser->object_stack_top == RJS_OBJECT_STACK_SIZE)
-		return 0;
+		if(key->name != NULL){
+			const char *name = key->name;
 
-	parser->object_stack[++parser->object_stack_top] = obj;
+			while(*(name++) != '\0')
+				count->chars++;
 
-	return 1;
-}
+			count->chars++;
+		}
 
-static int rjs_stack_popobject(rjs_parser_t *parser){
-	if(parser->object_stack_top == -1)
-		return 0;
+		if(key->value.type == RJS_KEY_STRING && key->value.data.str != NULL){
+			const char *str = key->value.data.str;
 
-	parser->object_stack_top--;
+			while(*(str++) != '\0')
+				count->chars++;
 
-	return 1;
+			count->chars++;
+		}
+		else if(key->value.type == RJS_KEY_OBJECT){
+			rjs_count_object(key->value.data.obj, count);
+		}
+	}
 }
 
-static rjs_object_t * rjs_stack_top(rjs_parser_t *parser){
-	if(parser->object_stack_top == -1)
-		return NULL;
+static const char *rjs_copy_string(char **cursor, const char *str){
+	char *location = *cursor;
 
-	return parser->object_stack[parser->object_stack_top];
-}
+	if(str == NULL)
+		return NULL;
 
-static int rjs_obj_pushkey(rjs_parser_t *parser, rjs_object_t *obj, rjs_key_t *new_key){
-	(void) parser;
+	while(*str != '\0')
+		*((*cursor)++) = *(str++);
 
-	if(obj->start_key == NULL){
-		obj->start_key = obj->end_key = new_key;
-	}
-	else{
-		obj->end_key->next = new_key;
-		obj->end_key = obj->end_key->next;
-	}
+	*((*cursor)++) = '\0';
 
-	return 1;
+	return location;
 }
 
-static int rjs_obj_pushkey_string(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str){
-	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
+static void rjs_reset_state(rjs_parser_t *parser){
+	parser->out_of_memory_flag = 0;
 
-	if(new_key == NULL)
-		return 0;
+	parser->tmp_token_pos = parser->tmp_value_pos = 0;
+	parser->object_stack_top = -1;
 
-	if(obj->is_array)
-		new_key->name = NULL;
-	else
-		new_key->name = rjs_pushstring(parser, key);
+	parser->error.code = RJS_ERROR_NONE;
+	parser->error.expected = NULL;
 
-	new_key->value.type = RJS_KEY_STRING;
-	new_key->value.data.str = rjs_pushstring(parser, str);
-	new_key->next = NULL;
+	parser->high_surrogate = 0;
+	parser->utf8_remaining = 0;
 
-	return rjs_obj_pushkey(parser, obj, new_key);
+	parser->filter_element = NULL;
+	parser->filter_rejected = 0;
+
+	parser->generation++;
 }
 
-static int rjs_obj_pushkey_number(rjs_parser_t *parser, rjs_object_t *obj, const char *key, const char *str){
-	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
+static int rjs_begin_document(rjs_parser_t *parser, const char *str){
+#ifdef RJS_ENABLE_STATS
+	if(parser->stats != NULL){
+		rjs_parse_stats_t empty = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+		*parser->stats = empty;
+	}
+#endif
 
-	if(new_key == NULL)
-		return 0;
+	parser->input = str;
+	parser->input_index = 0;
 
-	if(obj->is_array)
-		new_key->name = NULL;
-	else
-		new_key->name = rjs_pushstring(parser, key);
+	RJS_PROBE2(parse_start, parser, str);
 
-	new_key->value.type = RJS_KEY_NUMBER;
+	parser->document_top = parser->memory.top;
+	parser->document_string_top = parser->memory.string_top;
+	parser->edited = 0;
+	parser->start_object = rjs_create_obj(parser);
 
-	if(!rjs_strtod(str, &new_key->value.data.number))
+	if(parser->start_object == NULL){
+		rjs_log(parser, RJS_ERROR_OUT_OF_MEMORY, NULL, "Out of memory.");
+		parser->status = RJS_PARSE_ERROR;
+		RJS_PROBE3(parse_end, parser, parser->status, parser->input_index);
 		return 0;
+	}
 
-	new_key->next = NULL;
+	RJS_STAT_ADD(parser, objects, 1);
+	rjs_stack_pushobject(parser, parser->start_object);
 
-	return rjs_obj_pushkey(parser, obj, new_key);
-}
+	parser->state = RJS_SEARCH_OPEN_BRACKET;
+	parser->next_state = RJS_SEARCH_OPEN_BRACKET;
+	parser->status = RJS_PARSE_IN_PROGRESS;
 
-static int rjs_obj_pushkey_obj(rjs_parser_t *parser, rjs_object_t *obj, const char *key, rjs_object_t *new_obj){
-	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
+	return 1;
+}
 
-	if(new_key == NULL)
-		return 0;
+static int rjs_parse_again(rjs_parser_t *parser, const char *str){
+	parser->memory.top = parser->document_top;
+	parser->memory.string_top = parser->document_string_top;
 
-	if(obj->is_array)
-		new_key->name = NULL;
-	else
-		new_key->name = rjs_pushstring(parser, key);
+	rjs_reset_state(parser);
 
-	new_key->value.type = RJS_KEY_OBJECT;
-	new_key->value.data.obj = new_obj;
-	new_key->next = NULL;
+	if(!rjs_begin_document(parser, str))
+		return 0;
 
-	return rjs_obj_pushkey(parser, obj, new_key);
+	return rjs_parse_step_budget(parser, (rjs_size_t) -1) == RJS_PARSE_DONE;
 }
 
-static int rjs_obj_pushkey_bool(rjs_parser_t *parser, rjs_object_t *obj, const char *key, int value){
-	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
-
-	if(new_key == NULL)
-		return 0;
+static rjs_object_t *rjs_parse_region(rjs_parser_t *parser, const char *str, rjs_size_t start, int is_array){
+	rjs_object_t *region = rjs_create_obj(parser);
 
-	if(obj->is_array)
-		new_key->name = NULL;
-	else
-		new_key->name = rjs_pushstring(parser, key);
+	if(region == NULL){
+		parser->out_of_memory_flag = 0;
+		return NULL;
+	}
 
-	new_key->value.type = RJS_KEY_BOOLEAN;
-	new_key->value.data.r_bool = value;
-	new_key->next = NULL;
+	parser->tmp_token_pos = parser->tmp_value_pos = 0;
+	parser->object_stack_top = -1;
+	parser->high_surrogate = 0;
+	parser->utf8_remaining = 0;
 
-	return rjs_obj_pushkey(parser, obj, new_key);
-}
+	parser->input = str;
+	parser->input_index = start;
 
-static int rjs_obj_pushkey_null(rjs_parser_t *parser, rjs_object_t *obj, const char *key){
-	rjs_key_t *new_key = (rjs_key_t *) rjs_alloc(parser, sizeof(rjs_key_t));
+	if(is_array){
+		region->is_array = 1;
+		region->offset = start;
+		parser->input_index++;
+		parser->state = parser->next_state = RJS_SEARCH_VALUE;
+	}
+	else{
+		parser->state = parser->next_state = RJS_SEARCH_OPEN_BRACKET;
+	}
 
-	if(new_key == NULL)
-		return 0;
+	rjs_stack_pushobject(parser, region);
 
-	new_key->name = rjs_pushstring(parser, key);
-	new_key->value.type = RJS_KEY_NULL;
-	new_key->next = NULL;
+	if(rjs_parse_object(parser, (rjs_size_t) -1) != RJS_PARSE_DONE)
+		return NULL;
 
-	return rjs_obj_pushkey(parser, obj, new_key);
+	return region;
 }
 
-static int rjs_parse_object(rjs_parser_t *parser, const char *str, rjs_size_t *index){
-	rjs_size_t previous_break = 0;
+static int rjs_parse_object(rjs_parser_t *parser, rjs_size_t max_bytes){
+	const char *str = parser->input;
+	rjs_size_t *index = &parser->input_index;
+	rjs_size_t end = *index + max_bytes;
+
+	/* Caso a soma passe do maior valor possível, não há limite. */
+	if(end < *index)
+		end = (rjs_size_t) -1;
 
 	while(str[(*index)] != '\0' && (rjs_stack_top(parser) != NULL)){
+		if(*index >= end)
+			return RJS_PARSE_IN_PROGRESS;
 
 		if(!rjs_parse_object_step(parser, str, index)){
 			if(parser->out_of_memory_flag){
-				rjs_log(parser, "Out of memory.");
+				rjs_log(parser, RJS_ERROR_OUT_OF_MEMORY, NULL, "Out of memory.");
 			}
 
-			return 0;
+			return RJS_PARSE_ERROR;
 		}
 
 		if(parser->out_of_memory_flag){
-			rjs_log(parser, "Out of memory.");
-			return 0;
+			rjs_log(parser, RJS_ERROR_OUT_OF_MEMORY, NULL, "Out of memory.");
+			return RJS_PARSE_ERROR;
 		}
 
 		parser->state = parser->next_state;
-		if(str[(*index)] == '\n' && previous_break != *index){
-			previous_break = *index;
-			parser->line_count++;
-		}
 	}
 
 	if(rjs_stack_top(parser) != NULL){
-		rjs_log(parser, "Expected close bracket or comma character.");
-		return 0;
+		rjs_log(parser, RJS_ERROR_UNEXPECTED_END, rjs_stack_top(parser)->is_array ? "]" : "}", "Expected close bracket or comma character.");
+		return RJS_PARSE_ERROR;
 	}
 
-	return 1;
+	return RJS_PARSE_DONE;
 }
 
 static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size_t *index){
@@ -660,11 +2988,13 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 				(*index)++;
 			}
 			else if(current == '{'){
+				top_object->offset = *index;
+
 				(*index)++;
 				parser->next_state = RJS_SEARCH_TOKEN_STRING;
 			}
 			else{
-				rjs_log(parser, "Expected open bracket.");
+				rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "{", "Expected open bracket.");
 				success = 0;
 			}
 
@@ -685,7 +3015,7 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 				parser->next_state = RJS_SEARCH_END;
 			}
 			else{
-				rjs_log(parser, "Expected quote.");
+				rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "\"", "Expected quote.");
 				success = 0;
 			}
 
@@ -701,7 +3031,7 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 			}
 			else{
 				success = 0;
-				rjs_log(parser, "Expected colon.");
+				rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, ":", "Expected colon.");
 			}
 
 			break;
@@ -721,8 +3051,21 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 				parser->tmp_value_pos = 0;
 			}
 			else if(current == '{'){
+				rjs_size_t top = parser->memory.top;
 				rjs_object_t *new_obj = rjs_create_obj(parser);
-				rjs_stack_pushobject(parser, new_obj);
+
+				if(new_obj == NULL)
+					return 0;
+
+				if(parser->filter_count != 0 && parser->object_stack_top == parser->filter_depth && top_object->is_array)
+					rjs_filter_begin(parser, top_object, new_obj, top);
+
+				if(!rjs_stack_pushobject(parser, new_obj)){
+					rjs_log(parser, RJS_ERROR_MAX_DEPTH, NULL, "Maximum depth reached.");
+					return 0;
+				}
+
+				RJS_STAT_ADD(parser, objects, 1);
 
 				if(!rjs_obj_pushkey_obj(parser, top_object, parser->tmp_token, new_obj)){
 					success = 0;
@@ -733,8 +3076,19 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 			}
 			else if(current == '['){
 				rjs_object_t *new_obj = rjs_create_obj(parser);
+
+				if(new_obj == NULL)
+					return 0;
+
 				new_obj->is_array = 1;
-				rjs_stack_pushobject(parser, new_obj);
+				new_obj->offset = *index;
+
+				if(!rjs_stack_pushobject(parser, new_obj)){
+					rjs_log(parser, RJS_ERROR_MAX_DEPTH, NULL, "Maximum depth reached.");
+					return 0;
+				}
+
+				RJS_STAT_ADD(parser, arrays, 1);
 
 				if(!rjs_obj_pushkey_obj(parser, top_object, parser->tmp_token, new_obj)){
 					success = 0;
@@ -745,50 +3099,76 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 				parser->next_state = RJS_SEARCH_VALUE;
 			}
 			else if(current == 't'){
-				if(rjs_strncmp(str + *index, "true", 4) == 0){
-					if(!rjs_obj_pushkey_bool(parser, top_object, parser->tmp_token, 1)){
-						success = 0;
-						parser->out_of_memory_flag = 1;
-					}
+				/* A comparação para no '\0', então um literal cortado no fim
+				 * da string não é lido além dele. */
+				if(rjs_strncmp(str + *index, "true", 4) != 0){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "value", "Expected value: number, array, object, boolean or null.");
+					break;
 				}
 
 				*index += 4;
 				parser->next_state = RJS_SEARCH_END;
+
+				if(!rjs_obj_pushkey_bool(parser, top_object, parser->tmp_token, 1)){
+					success = 0;
+					parser->out_of_memory_flag = 1;
+				}
 			}
 			else if(current == 'f'){
-				if(rjs_strncmp(str + *index, "false", 5) == 0){
-					if(!rjs_obj_pushkey_bool(parser, top_object, parser->tmp_token, 0)){
-						success = 0;
-						parser->out_of_memory_flag = 1;
-					}
+				/* A comparação para no '\0', então um literal cortado no fim
+				 * da string não é lido além dele. */
+				if(rjs_strncmp(str + *index, "false", 5) != 0){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "value", "Expected value: number, array, object, boolean or null.");
+					break;
 				}
 
 				*index += 5;
 				parser->next_state = RJS_SEARCH_END;
+
+				if(!rjs_obj_pushkey_bool(parser, top_object, parser->tmp_token, 0)){
+					success = 0;
+					parser->out_of_memory_flag = 1;
+				}
 			}
 			else if(current == 'n'){
-				if(rjs_strncmp(str + *index, "null", 4) == 0){
-					if(!rjs_obj_pushkey_null(parser, top_object, parser->tmp_token)){
-						success = 0;
-						parser->out_of_memory_flag = 1;
-					}
+				/* A comparação para no '\0', então um literal cortado no fim
+				 * da string não é lido além dele. */
+				if(rjs_strncmp(str + *index, "null", 4) != 0){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "value", "Expected value: number, array, object, boolean or null.");
+					break;
 				}
 
 				*index += 4;
 				parser->next_state = RJS_SEARCH_END;
+
+				if(!rjs_obj_pushkey_null(parser, top_object, parser->tmp_token)){
+					success = 0;
+					parser->out_of_memory_flag = 1;
+				}
 			}
 			else if(current == ']' || current == '}'){
 				parser->next_state = RJS_SEARCH_END;
 			}
 			else{
 				success = 0;
-				rjs_log(parser, "Expected value: number, array, object, boolean or null.");
+				rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "value", "Expected value: number, array, object, boolean or null.");
 			}
 
 			break;
 
 		case RJS_READ_VALUE_STRING:
-			if(current == '\"'){
+			if(parser->high_surrogate != 0 && current != '\\'){
+				success = 0;
+				rjs_log(parser, RJS_ERROR_INVALID_STRING, "\\u", "Expected low surrogate.");
+			}
+			else if(parser->utf8_remaining != 0 && (current == '\"' || current == '\\')){
+				success = 0;
+				rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Invalid UTF-8.");
+			}
+			else if(current == '\"'){
 				(*index)++;
 				
 				if(parser->tmp_value_pos == -1){
@@ -811,13 +3191,23 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 
 				parser->next_state = RJS_READ_VALUE_STRING_CONTROL;
 			}
+			else if((unsigned char) current < 0x80 && parser->utf8_remaining == 0){
+				/* Copia de uma vez todos os caracteres ASCII até o próximo
+				 * caractere especial. */
+				rjs_size_t end = rjs_scan_plain(str, *index + 1);
+
+				for(; *index < end; (*index)++)
+					rjs_add_string_character(parser, str[*index]);
+			}
 			else{
 				(*index)++;
 
-				if(parser->tmp_value_pos == -1)
-					rjs_add_character(parser->tmp_token, parser->tmp_token_pos++, current);
-				else
-					rjs_add_character(parser->tmp_value, parser->tmp_value_pos++, current);
+				if((parser->flags & RJS_FLAG_VALIDATE_UTF8) && !rjs_validate_utf8(parser, (unsigned char) current)){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Invalid UTF-8.");
+				}
+
+				rjs_add_string_character(parser, current);
 			}
 
 			break;
@@ -835,15 +3225,25 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 				else if(current == 'r') control = '\r';
 				else if(current == 't') control = '\t';
 
-				if(control == '\0'){
+				if(current == 'u'){
+					(*index)++;
+
+					parser->unicode = 0;
+					parser->unicode_digits = 0;
+					parser->next_state = RJS_READ_VALUE_STRING_UNICODE;
+				}
+				else if(parser->high_surrogate != 0){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, "\\u", "Expected low surrogate.");
+				}
+				else if(control == '\0'){
 					success = 0;
-					rjs_log(parser, "Expected control character.");
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Expected control character.");
 				}
 				else{
-					if(parser->tmp_value_pos == -1)
-						rjs_add_character(parser->tmp_token, parser->tmp_token_pos++, control);
-					else
-						rjs_add_character(parser->tmp_value, parser->tmp_value_pos++, control);
+					rjs_add_string_character(parser, control);
+
+					RJS_STAT_ADD(parser, escapes, 1);
 
 					(*index)++;
 					parser->next_state = RJS_READ_VALUE_STRING;
@@ -852,15 +3252,67 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 
 			break;
 
+		case RJS_READ_VALUE_STRING_UNICODE:
+			{
+				int digit = rjs_hex_digit(current);
+
+				if(digit == -1){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Expected hexadecimal digit.");
+					break;
+				}
+
+				(*index)++;
+				parser->unicode = parser->unicode * 16 + (unsigned long) digit;
+
+				if(++parser->unicode_digits < 4)
+					break;
+
+				parser->next_state = RJS_READ_VALUE_STRING;
+				RJS_STAT_ADD(parser, escapes, 1);
+
+				if(parser->high_surrogate != 0){
+					if(parser->unicode < 0xDC00 || parser->unicode > 0xDFFF){
+						success = 0;
+						rjs_log(parser, RJS_ERROR_INVALID_STRING, "\\u", "Expected low surrogate.");
+					}
+					else{
+						rjs_add_codepoint(parser, 0x10000 + ((parser->high_surrogate - 0xD800) << 10) + (parser->unicode - 0xDC00));
+						parser->high_surrogate = 0;
+					}
+				}
+				else if(parser->unicode >= 0xD800 && parser->unicode <= 0xDBFF){
+					parser->high_surrogate = parser->unicode;
+				}
+				else if(parser->unicode >= 0xDC00 && parser->unicode <= 0xDFFF){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Unexpected low surrogate.");
+				}
+				else if(parser->unicode == 0){
+					success = 0;
+					rjs_log(parser, RJS_ERROR_INVALID_STRING, NULL, "Null character in string.");
+				}
+				else{
+					rjs_add_codepoint(parser, parser->unicode);
+				}
+			}
+
+			break;
+
 		case RJS_READ_VALUE_NUMBER:
 			if(rjs_isspace(current) || current == ',' || current == '}' || current == ']'){
 				rjs_add_character(parser->tmp_value, parser->tmp_value_pos++, '\0');
 
 				parser->next_state = RJS_SEARCH_END;
 
-				if(!rjs_obj_pushkey_number(parser, top_object, parser->tmp_token, parser->tmp_value)){
+				/* O número são os tmp_value_pos - 1 caracteres antes do atual. */
+				if(!rjs_obj_pushkey_number(parser, top_object, parser->tmp_token, parser->tmp_value,
+						str + (*index - (rjs_size_t) (parser->tmp_value_pos - 1)))){
 					success = 0;
-					rjs_log(parser, "Error while parsing number.");
+
+					/* Sem memória, o erro é registrado por rjs_parse_object. */
+					if(!parser->out_of_memory_flag)
+						rjs_log(parser, RJS_ERROR_INVALID_NUMBER, NULL, "Error while parsing number.");
 				}
 			}
 			else{
@@ -886,26 +3338,34 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 			else if(current == '}'){
 				if(top_object->is_array){
 					success = 0;
-					rjs_log(parser, "Expected square bracket.");
+					rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "]", "Expected square bracket.");
 				}
 				else{
 					(*index)++;
-					rjs_stack_popobject(parser);
+
+					if(top_object == parser->filter_element)
+						rjs_filter_close(parser);
+					else
+						rjs_stack_closeobject(parser, *index);
 				}
 			}
 			else if(current == ']'){
 				if(!top_object->is_array){
 					success = 0;
-					rjs_log(parser, "Expected close bracket.");
+					rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, "}", "Expected close bracket.");
 				}
 				else{
 					(*index)++;
-					rjs_stack_popobject(parser);
+
+					if(parser->flags & RJS_FLAG_PACK_NUMBERS)
+						rjs_pack_numbers(parser, top_object);
+
+					rjs_stack_closeobject(parser, *index);
 				}
 			}
 			else{
 				success = 0;
-				rjs_log(parser, "Expected close bracket or comma character.");
+				rjs_log(parser, RJS_ERROR_UNEXPECTED_TOKEN, top_object->is_array ? ", or ]" : ", or }", "Expected close bracket or comma character.");
 			}
 
 			break;
@@ -913,3 +3373,78 @@ static int rjs_parse_object_step(rjs_parser_t *parser, const char *str, rjs_size
 
 	return success;
 }
+
+static int rjs_reader_error(rjs_reader_t *reader, const char *message){
+	rjs_write_log(reader->error_log, reader->line_count, message);
+	reader->state = RJS_FAILED;
+
+	return RJS_READER_ERROR;
+}
+
+static int rjs_reader_copy(rjs_reader_t *reader, const char *str, rjs_size_t length){
+	rjs_size_t i;
+
+	if(reader->buffer_size - reader->buffer_pos <= length)
+		return 0;
+
+	for(i = 0; i < length; i++)
+		reader->buffer[reader->buffer_pos++] = str[i];
+
+	reader->copying = 1;
+
+	return 1;
+}
+
+static int rjs_reader_flush(rjs_reader_t *reader){
+	rjs_size_t start = reader->segment;
+
+	reader->segment = reader->input_index;
+
+	return rjs_reader_copy(reader, reader->input + start, reader->input_index - start);
+}
+
+static int rjs_reader_push(rjs_reader_t *reader, int is_array){
+	if(reader->depth >= RJS_OBJECT_STACK_SIZE)
+		return 0;
+
+	reader->is_array[reader->depth++] = (unsigned char) is_array;
+
+	return 1;
+}
+
+static int rjs_reader_close(rjs_reader_t *reader, char current, rjs_event_t *event){
+	int is_array = reader->is_array[reader->depth - 1];
+
+	if(current == '}' && is_array)
+		return rjs_reader_error(reader, "Expected square bracket.");
+
+	if(current == ']' && !is_array)
+		return rjs_reader_error(reader, "Expected close bracket.");
+
+	reader->input_index++;
+	reader->depth--;
+	reader->skip_value = 0;
+	reader->state = reader->depth == 0 ? RJS_FINISHED : RJS_EXPECT_END;
+
+	rjs_reader_emit(reader, event, is_array ? RJS_EVENT_END_ARRAY : RJS_EVENT_END_OBJECT);
+
+	return RJS_READER_EVENT;
+}
+
+static int rjs_reader_emit(rjs_reader_t *reader, rjs_event_t *event, int type){
+	if(reader->skip_value && type >= RJS_EVENT_STRING){
+		reader->skip_value = 0;
+		return 0;
+	}
+
+	event->type = type;
+	event->depth = reader->depth;
+
+	/* O início de um objeto já o conta na profundidade. */
+	if(type == RJS_EVENT_BEGIN_OBJECT || type == RJS_EVENT_BEGIN_ARRAY)
+		event->depth--;
+
+	reader->last_event = type;
+
+	return 1;
+}
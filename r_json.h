@@ -25,8 +25,36 @@ extern "C" {
 #define RJS_MAX_STRING_SIZE 256
 #define RJS_OBJECT_STACK_SIZE 256
 
+/* Estados de uma leitura feita em partes, retornados por
+ * rjs_parse_step_budget. */
+#define RJS_PARSE_ERROR 0
+#define RJS_PARSE_DONE 1
+#define RJS_PARSE_IN_PROGRESS 2
+
+/* Flags do parser, definidas com rjs_set_flags. */
+
+/* Arrays cujos elementos são todos números são armazenadas como uma
+ * array contígua de doubles, sem chaves. Veja rjs_get_numbers. */
+#define RJS_FLAG_PACK_NUMBERS 1
+
+/* Strings que não sejam UTF-8 válido são rejeitadas durante a leitura. */
+#define RJS_FLAG_VALIDATE_UTF8 2
+
+/* Números não são convertidos durante a leitura: apenas a sua sintaxe é
+ * verificada, e a chave aponta para o seu texto no texto lido, sem cópia.
+ * Por isso o texto lido precisa continuar válido, e sem mudanças, enquanto o
+ * documento for usado. rjs_get_vnumber converte o número a cada acesso, sem
+ * alterar o documento, e rjs_cache_number o converte e guarda na chave; o
+ * rjs_compact converte todos de uma vez. O texto pode ser obtido com
+ * rjs_get_vraw. Nesse modo, arrays de números não são compactadas por
+ * RJS_FLAG_PACK_NUMBERS, e rjs_reparse lê o documento por inteiro. */
+#define RJS_FLAG_LAZY_NUMBERS 4
+
 typedef unsigned long rjs_size_t;
 
+/* Quantidade máxima de predicados em rjs_set_filter. */
+#define RJS_MAX_PREDICATES 16
+
 /* Enum para os tipos de valores que uma chave
  * em json pode ser. */
 enum rjs_key_type {
@@ -39,11 +67,86 @@ enum rjs_key_type {
 
 typedef struct rjs_object_s rjs_object_t;
 
-/* Estrutura para o manuseamento de memória. */
+/* Tipos de erro de uma leitura (veja rjs_get_error_info). */
+enum rjs_error_code {
+	RJS_ERROR_NONE = 0,
+	RJS_ERROR_OUT_OF_MEMORY,
+	RJS_ERROR_UNEXPECTED_TOKEN,
+	RJS_ERROR_UNEXPECTED_END,
+	RJS_ERROR_MAX_DEPTH,
+	RJS_ERROR_INVALID_STRING,
+	RJS_ERROR_INVALID_NUMBER
+};
+
+/* Erro da última leitura. offset é a posição, em bytes, no texto lido; line
+ * e column (em bytes) começam em 1 e só são calculadas quando o erro acontece.
+ * expected é o que era esperado na posição, como "{", ":" ou "value", ou NULL
+ * caso o erro não seja de um caractere inesperado. */
+typedef struct {
+	int code;
+	rjs_size_t offset;
+	int line;
+	rjs_size_t column;
+	const char *expected;
+} rjs_error_t;
+
+/* Comparações dos predicados de rjs_set_filter. */
+enum rjs_filter_op {
+	RJS_FILTER_EQUAL = 0,
+	RJS_FILTER_NOT_EQUAL,
+	RJS_FILTER_LESS,
+	RJS_FILTER_LESS_EQUAL,
+	RJS_FILTER_GREATER,
+	RJS_FILTER_GREATER_EQUAL
+};
+
+/* Predicado sobre uma chave dos elementos filtrados (veja rjs_set_filter). O
+ * elemento só é mantido caso tenha a chave name, com um valor do tipo type
+ * (RJS_KEY_STRING, RJS_KEY_NUMBER, RJS_KEY_BOOLEAN ou RJS_KEY_NULL) que,
+ * comparado com str, number ou r_bool segundo op, satisfaça o predicado.
+ * Strings são comparadas byte a byte. */
+typedef struct {
+	const char *name;
+	int op;
+	int type;
+
+	const char *str;
+	double number;
+	int r_bool;
+} rjs_predicate_t;
+
+/* Estatísticas de uma leitura, preenchidas por rjs_parse_string caso o parser
+ * tenha uma estrutura definida com rjs_set_stats. Elas só são coletadas caso
+ * a biblioteca seja compilada com RJS_ENABLE_STATS; caso contrário, nenhum
+ * código é gerado para elas. Os ciclos só são contados com
+ * RJS_ENABLE_STATS_CYCLES, em processadores x86 com GCC ou Clang. */
+typedef struct {
+	rjs_size_t bytes; /* Bytes lidos da string. */
+	rjs_size_t objects; /* Objetos criados, sem contar arrays. */
+	rjs_size_t arrays; /* Arrays criadas. */
+	rjs_size_t keys; /* Chaves criadas, incluindo elementos de arrays. */
+	rjs_size_t strings; /* Valores do tipo string. */
+	rjs_size_t numbers; /* Valores do tipo número. */
+	rjs_size_t escapes; /* Caracteres de controle (\n, \" etc.) lidos. */
+	rjs_size_t arena_high_water; /* Maior quantidade de memória utilizada. */
+	rjs_size_t padding; /* Bytes perdidos com o alinhamento. */
+	int max_depth; /* Maior profundidade alcançada. */
+
+	unsigned long cycles_total; /* Ciclos gastos na leitura. */
+	unsigned long cycles_tokenize; /* Ciclos gastos fora da conversão de números e alocação. */
+	unsigned long cycles_number; /* Ciclos gastos na conversão de números. */
+	unsigned long cycles_alloc; /* Ciclos gastos em alocações. */
+} rjs_parse_stats_t;
+
+/* Estrutura para o manuseamento de memória. Chaves e objetos são alocados
+ * do começo do bloco para o fim, alinhados, e strings do fim do bloco para o
+ * começo, sem alinhamento. Assim as chaves ficam juntas nas mesmas linhas de
+ * cache, sem bytes de strings entre elas. */
 typedef struct rjs_mem_s {
 	char *block; /* Bloco de memória. */
 	rjs_size_t size; /* Tamanho do bloco de memória. */
 	rjs_size_t top; /* Topo da memória para indicar onde ela está livre. */
+	rjs_size_t string_top; /* Início da região de strings. */
 } rjs_mem_t;
 
 /* Estrutura que guardará os dados do parser de json. */
@@ -51,6 +154,15 @@ typedef struct {
 	rjs_mem_t memory;
 	rjs_object_t *start_object;
 
+	/* Memória livre antes do último documento, para que rjs_reparse o leia
+	 * de novo sem descartar os anteriores (veja rjs_parse_document). */
+	rjs_size_t document_top;
+	rjs_size_t document_string_top;
+
+	/* O último documento foi mudado pelas funções de edição, e não corresponde
+	 * mais ao texto lido, então rjs_reparse precisa lê-lo por inteiro. */
+	int edited;
+
 	/* String temporária para armazenar os nomes de tokens. */
 	char tmp_token[RJS_MAX_STRING_SIZE];
 	int tmp_token_pos;
@@ -76,8 +188,55 @@ typedef struct {
 	int state;
 	int next_state;
 
-	/* Contador de linha, utilizado para mensagens de erros. */
-	int line_count;
+	/* Erro da última leitura. A linha não é contada durante a leitura: é
+	 * calculada a partir de input_index somente quando há um erro. */
+	rjs_error_t error;
+
+	/* String sendo lida e a posição atual. Guardadas no parser para que a
+	 * leitura possa ser feita em partes. */
+	const char *input;
+	rjs_size_t input_index;
+
+	/* Estado da leitura atual (RJS_PARSE_*). */
+	int status;
+
+	/* Estado da leitura de caracteres do tipo \uXXXX: o valor lido, a
+	 * quantidade de dígitos e o primeiro surrogate de um par, caso haja. */
+	unsigned long unicode;
+	int unicode_digits;
+	unsigned long high_surrogate;
+
+	/* Estado do validador de UTF-8: bytes de continuação que faltam e os
+	 * limites do próximo byte. */
+	int utf8_remaining;
+	unsigned char utf8_lower;
+	unsigned char utf8_upper;
+
+	/* Flags de configuração, veja RJS_FLAG_*. */
+	int flags;
+
+	/* Estatísticas da leitura, ou NULL. Veja rjs_set_stats. */
+	rjs_parse_stats_t *stats;
+
+	/* Predicados de rjs_set_filter e a profundidade das arrays filtradas. */
+	const rjs_predicate_t *filters;
+	int filter_count;
+	int filter_depth;
+
+	/* Elemento sendo filtrado, ou NULL, os predicados que ele já satisfez e
+	 * o estado da memória e da array antes dele, para que seja descartado. */
+	rjs_object_t *filter_element;
+	unsigned long filter_matched;
+	rjs_size_t filter_top;
+	rjs_size_t filter_string_top;
+	struct rjs_key_s *filter_end_key;
+
+	/* Elementos descartados na última leitura. */
+	rjs_size_t filter_rejected;
+
+	/* Muda a cada leitura e edição, para que um índice de caminhos saiba
+	 * que o documento mudou (veja rjs_build_index). */
+	rjs_size_t generation;
 } rjs_parser_t;
 
 /* Estrutura para organizar os valores de json. */
@@ -89,11 +248,17 @@ typedef struct {
 		double number;
 		const rjs_object_t *obj;
 		int r_bool;
+		const char *raw;
 	} data;
 
 	/* O tipo, definido segundo o enum declarado no topo
 	 * desse header. */
 	int type;
+
+	/* Indica que o número ainda não foi convertido e data.raw aponta para o
+	 * seu texto no texto lido (veja RJS_FLAG_LAZY_NUMBERS). Use
+	 * rjs_get_vnumber para lê-lo. */
+	int is_lazy;
 } rjs_value_t;
 
 typedef struct rjs_key_s {
@@ -115,8 +280,35 @@ struct rjs_object_s {
 
 	/* Indica caso o objeto seja uma array. */
 	int is_array;
+
+	/* Quantidade de chaves (ou de números, caso a array seja compactada). */
+	rjs_size_t length;
+
+	/* Caso a array tenha sido compactada (veja RJS_FLAG_PACK_NUMBERS),
+	 * aponta para os seus números e start_key será NULL. Caso contrário,
+	 * será NULL. */
+	const double *numbers;
+	/* Posição do objeto no texto lido e o seu tamanho em bytes, do colchete
+	 * (ou chave) de abertura ao de fechamento. A posição é relativa ao
+	 * objeto pai, exceto no objeto principal, para que uma edição no texto
+	 * só mude as posições dos objetos que vêm depois dela no mesmo pai
+	 * (veja rjs_reparse). Objetos criados por rjs_new_object têm tamanho 0. */
+	rjs_size_t offset;
+	rjs_size_t size;
 };
 
+/* Ponto da memória do parser, guardado por rjs_mark para que rjs_rollback
+ * descarte tudo o que foi alocado depois dele. */
+typedef struct {
+	rjs_size_t top;
+	rjs_size_t string_top;
+	rjs_object_t *start_object;
+	int status;
+	rjs_size_t document_top;
+	rjs_size_t document_string_top;
+	int edited;
+} rjs_mark_t;
+
 /* Cria o parser, com um dado bloco de memória e o seu tamanho.
  * Retorna 1 caso crie o parser com sucesso, 0 em caso contrário. */
 int rjs_create_parser(rjs_parser_t *parser, char *block, rjs_size_t size);
@@ -125,15 +317,78 @@ int rjs_create_parser(rjs_parser_t *parser, char *block, rjs_size_t size);
  * chamada pela função rjs_create_parser, então não é preciso se preocupar. */
 int rjs_clean_parser(rjs_parser_t *parser);
 
+/* Define as flags do parser (veja RJS_FLAG_*). As flags são mantidas entre
+ * leituras. Retorna 1. */
+int rjs_set_flags(rjs_parser_t *parser, int flags);
+
+/* Define a estrutura onde as estatísticas das próximas leituras serão
+ * escritas, ou NULL para não coletá-las. Só tem efeito caso a biblioteca seja
+ * compilada com RJS_ENABLE_STATS. Retorna 1. */
+int rjs_set_stats(rjs_parser_t *parser, rjs_parse_stats_t *stats);
+
+/* Filtra, durante a leitura, os objetos que são elementos das arrays na
+ * profundidade depth (o objeto principal tem profundidade 0, e uma array que
+ * é uma das suas chaves, 1). Um elemento só é mantido caso satisfaça todos os
+ * n predicados. Assim que uma chave não satisfaz o seu predicado, o resto do
+ * elemento é só percorrido, sem ser validado, e a memória que ele usou é
+ * devolvida; elementos sem alguma das chaves são descartados ao fim deles.
+ * Elementos que não são objetos são mantidos. Os predicados não são copiados
+ * e precisam existir enquanto o parser for usado. Com n igual a 0, o filtro é
+ * desativado. Retorna 0 caso n passe de RJS_MAX_PREDICATES ou depth seja
+ * menor que 1. */
+int rjs_set_filter(rjs_parser_t *parser, const rjs_predicate_t *predicates, int n, int depth);
+
+/* Retorna quantos elementos foram descartados pelo filtro na última leitura. */
+rjs_size_t rjs_get_rejected(rjs_parser_t *parser);
+
 /* Lê e decodifica uma string de json. Retorna 1 caso haja sucesso e 0
  * em caso contrário.
  * Caso haja um erro, ele será impresso no log interno. Chame a função
  * rjs_get_error() para receber a mensagem de erro. */
 int rjs_parse_string(rjs_parser_t *parser, const char *str);
 
+/* Prepara a leitura de uma string em partes, com rjs_parse_step_budget.
+ * A string deve continuar válida até o fim da leitura. Retorna 1 caso haja
+ * sucesso e 0 em caso contrário. */
+int rjs_parse_begin(rjs_parser_t *parser, const char *str);
+
+/* Continua a leitura começada por rjs_parse_begin, lendo aproximadamente até
+ * max_bytes bytes da string, e parando exatamente onde parou para que a
+ * próxima chamada continue dali. Útil para dividir uma leitura grande entre
+ * vários quadros de um jogo, por exemplo.
+ * Retorna RJS_PARSE_IN_PROGRESS caso ainda haja o que ler, RJS_PARSE_DONE ao
+ * terminar e RJS_PARSE_ERROR caso haja um erro. Depois do fim, sempre retorna
+ * o mesmo resultado. */
+int rjs_parse_step_budget(rjs_parser_t *parser, rjs_size_t max_bytes);
+
+/* Lê mais um documento na memória do parser, sem descartar os documentos
+ * lidos antes, e retorna o seu objeto principal, que também passa a ser o
+ * retornado por rjs_get_main_object. Assim, documentos que duram muito e
+ * documentos temporários podem dividir o mesmo bloco. Caso a leitura falhe,
+ * a memória usada por ela é devolvida, o objeto principal volta a ser o
+ * anterior e NULL é retornado. rjs_parse_string e rjs_clean_parser
+ * descartam todos os documentos. */
+const rjs_object_t * rjs_parse_document(rjs_parser_t *parser, const char *str);
+
+/* Guarda em mark o ponto atual da memória do parser e o seu objeto
+ * principal. Retorna 0 durante uma leitura em partes. */
+int rjs_mark(rjs_parser_t *parser, rjs_mark_t *mark);
+
+/* Descarta tudo o que foi alocado depois de rjs_mark: documentos lidos com
+ * rjs_parse_document e valores criados por edições, inclusive em documentos
+ * anteriores à marca, que por isso não devem ser editados entre a marca e
+ * o retorno a ela. O objeto principal volta a ser o da marca. Marcas feitas
+ * depois desta deixam de valer, assim como todas depois de rjs_parse_string
+ * ou rjs_clean_parser. Retorna 0 caso a marca esteja além da memória em uso. */
+int rjs_rollback(rjs_parser_t *parser, const rjs_mark_t *mark);
+
 /* Retorna a mensagem de erro, caso haja. */
 const char * rjs_get_error(rjs_parser_t *parser);
 
+/* Retorna o erro da última leitura, com o tipo, a posição, a linha e a coluna.
+ * code é RJS_ERROR_NONE caso não haja erro. */
+const rjs_error_t * rjs_get_error_info(rjs_parser_t *parser);
+
 /* Retorna o objeto principal do arquivo json. Caso não haja,
  * retorna NULL */
 const rjs_object_t * rjs_get_main_object(rjs_parser_t *parser);
@@ -143,10 +398,41 @@ const rjs_object_t * rjs_get_main_object(rjs_parser_t *parser);
  * A busca é linear, pois a lista utilizada é uma lista encadeada. */
 const rjs_key_t * rjs_get_key(const rjs_object_t *object, const char *name);
 
+/* Busca várias chaves de uma vez, percorrendo o objeto apenas uma vez. A
+ * chave com o nome names[i] é escrita em keys[i], ou NULL caso ela não seja
+ * encontrada. Os nomes são agrupados pelo primeiro caractere, então cada
+ * chave só é comparada com os nomes que começam como ela. Compensa quando
+ * muitos nomes são buscados em objetos com muitas chaves; em objetos pequenos,
+ * que ficam no cache, chamadas separadas a rjs_get_key podem ser mais
+ * rápidas. Retorna quantas chaves foram encontradas. */
+rjs_size_t rjs_get_keys(const rjs_object_t *object, const char * const *names, rjs_size_t n, const rjs_key_t **keys);
+
+/* Busca a chave com um dado nome a partir de *cursor (ou do começo, caso
+ * *cursor seja NULL), voltando ao começo do objeto caso chegue ao fim, e
+ * avança *cursor para depois dela. Buscas seguidas de chaves que estão na
+ * mesma ordem no objeto custam uma comparação cada. Retorna NULL caso o
+ * objeto seja NULL, uma array ou não tenha a chave. */
+const rjs_key_t * rjs_get_key_from(const rjs_object_t *object, const rjs_key_t **cursor, const char *name);
+
 /* Retorna a chave em uma dada posição. Útil para arrays.
  * Caso não haja uma chave naquela posição, retorna NULL. */
 const rjs_key_t * rjs_get_key_index(const rjs_object_t *object, rjs_size_t pos);
 
+/* Retorna a chave no caminho dado, no formato JSON Pointer: nomes e posições
+ * separados por '/', com "~1" no lugar de '/' e "~0" no lugar de '~' nos
+ * nomes, como em "/statuses/0/user/name". O caminho é percorrido chave a
+ * chave, como em chamadas seguidas de rjs_get_key. Elementos de arrays
+ * compactadas não têm chaves e não são encontrados. Retorna NULL caso a chave
+ * não exista ou o caminho seja vazio. */
+const rjs_key_t * rjs_get_path(const rjs_object_t *object, const char *path);
+
+/* Retorna a quantidade de elementos de um objeto ou array. */
+rjs_size_t rjs_get_length(const rjs_object_t *object);
+
+/* Retorna os números de uma array compactada e armazena a sua quantidade
+ * em length. Caso a array não tenha sido compactada, retorna NULL. */
+const double * rjs_get_numbers(const rjs_object_t *object, rjs_size_t *length);
+
 /* Retorna 1 se a chave é de um dado tipo, 0 caso contrário. */
 int rjs_istype(const rjs_key_t *key, int type);
 
@@ -165,6 +451,20 @@ const char * rjs_get_vstring(const rjs_key_t *key);
  * da chave. */
 double rjs_get_vnumber(const rjs_key_t *key);
 
+/* Converte um número lido com RJS_FLAG_LAZY_NUMBERS e o guarda na chave, para
+ * que os próximos acessos não o convertam de novo; depois disso, rjs_get_vraw
+ * retorna NULL. Altera o documento, então não deve ser chamada enquanto
+ * outras threads o leem. Para outros números, é o mesmo que rjs_get_vnumber.
+ * Retorna o número. */
+double rjs_cache_number(rjs_parser_t *parser, const rjs_key_t *key);
+
+/* Retorna o texto de um número lido com RJS_FLAG_LAZY_NUMBERS, exatamente
+ * como estava no documento, para que ele possa ser repassado sem perder
+ * precisão, e escreve o seu tamanho em length, caso não seja NULL. O texto
+ * está dentro do texto lido e não termina em '\0'. Para outras chaves, ou
+ * números já guardados por rjs_cache_number, retorna NULL. */
+const char * rjs_get_vraw(const rjs_key_t *key, rjs_size_t *length);
+
 /* Retorna o valor booleano armazenado em uma chave. Verifique previamente qual
  * o tipo da chave. */
 int rjs_get_vbool(const rjs_key_t *key);
@@ -172,6 +472,284 @@ int rjs_get_vbool(const rjs_key_t *key);
 /* Retorna uma string que indica o nome do tipo. */
 const char * rjs_get_typename(const rjs_key_t *key);
 
+/* Extrai colunas de números de uma array de objetos, percorrendo-a apenas uma
+ * vez. Para cada objeto da array, o valor da chave key_names[j] é escrito em
+ * columns[j][linha]. Cada coluna deve ter espaço para max_rows números.
+ * As chaves são buscadas com rjs_get_key_from, então objetos com as chaves na
+ * mesma ordem de key_names custam uma comparação por chave.
+ * O número de linhas escritas é armazenado em rows. Retorna 1 caso haja
+ * sucesso, 0 caso array não seja uma array de objetos (arrays compactadas só
+ * têm números), algum elemento seja uma array, não tenha alguma das chaves,
+ * a chave não seja um número ou haja mais de max_rows elementos. */
+int rjs_extract_columns(const rjs_object_t *array, const char * const *key_names, rjs_size_t n, double * const *columns, rjs_size_t max_rows, rjs_size_t *rows);
+
+/* Copia os números de uma array para out, que deve ter espaço para max
+ * números, percorrendo-a apenas uma vez. Arrays compactadas (veja
+ * RJS_FLAG_PACK_NUMBERS) são copiadas direto. O número de elementos escritos
+ * é armazenado em count. Retorna 1 caso haja sucesso, 0 caso algum elemento
+ * não seja um número (count indica então a sua posição) ou a array tenha mais
+ * de max elementos. */
+int rjs_array_to_doubles(const rjs_object_t *array, double *out, rjs_size_t max, rjs_size_t *count);
+
+/* Como rjs_array_to_doubles, mas para arrays de strings. As strings
+ * continuam pertencendo à memória do parser. */
+int rjs_array_to_strings(const rjs_object_t *array, const char **out, rjs_size_t max, rjs_size_t *count);
+
+/* Retorna quantos bytes a função rjs_compact precisa para copiar o documento
+ * lido pelo parser. */
+rjs_size_t rjs_compact_size(rjs_parser_t *parser);
+
+/* Copia o documento lido pelo parser para outro bloco de memória, em uma
+ * ordem que favorece a leitura: os objetos ficam juntos, as chaves de um
+ * mesmo objeto ficam contíguas e as strings ficam em uma região separada.
+ * O bloco deve estar alinhado como um bloco retornado pelo malloc, e pode ter
+ * exatamente o tamanho retornado por rjs_compact_size. A cópia não depende da
+ * memória do parser, que pode ser reutilizada para a próxima leitura.
+ * Números ainda não convertidos (veja RJS_FLAG_LAZY_NUMBERS) são convertidos
+ * na cópia. Retorna o objeto principal da cópia, ou NULL caso o bloco seja pequeno
+ * demais ou não haja documento. */
+const rjs_object_t * rjs_compact(rjs_parser_t *parser, char *block, rjs_size_t size);
+
+/* Edição do documento. As funções abaixo alteram o documento lido pelo
+ * parser, alocando o que for preciso da memória do próprio parser. As chaves
+ * e objetos passados devem pertencer ao documento do parser. A memória de
+ * valores substituídos ou removidos só é devolvida na próxima leitura.
+ * As funções que retornam int retornam 1 caso haja sucesso e 0 caso falte
+ * memória ou os argumentos sejam inválidos. */
+
+/* Cria um objeto vazio, ou uma array vazia caso is_array seja 1. O objeto
+ * pode ser colocado no documento com rjs_set_object. Retorna NULL caso não
+ * haja memória. */
+const rjs_object_t * rjs_new_object(rjs_parser_t *parser, int is_array);
+
+/* Substituem o valor de uma chave por um número, string, booleano, null ou
+ * objeto, respectivamente. O objeto de rjs_set_object não deve conter a
+ * própria chave. */
+int rjs_set_number(rjs_parser_t *parser, const rjs_key_t *key, double number);
+int rjs_set_string(rjs_parser_t *parser, const rjs_key_t *key, const char *str);
+int rjs_set_bool(rjs_parser_t *parser, const rjs_key_t *key, int value);
+int rjs_set_null(rjs_parser_t *parser, const rjs_key_t *key);
+int rjs_set_object(rjs_parser_t *parser, const rjs_key_t *key, const rjs_object_t *object);
+
+/* Retorna a chave com o nome dado, criando-a com o valor null no fim do
+ * objeto caso ela não exista. Em objetos, a busca pelo nome é O(n) no número
+ * de chaves. Em arrays, o nome é ignorado e um novo elemento é sempre criado
+ * no fim, em O(1). Retorna NULL caso não haja memória. */
+const rjs_key_t * rjs_insert_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name);
+
+/* Cria uma chave com o valor null no fim do objeto, em O(1), sem procurar
+ * uma chave com o mesmo nome: quem chama garante que o nome é novo. Em
+ * arrays, é o mesmo que rjs_insert_key. Retorna NULL caso não haja memória. */
+const rjs_key_t * rjs_append_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name);
+
+/* Remove a chave com o nome dado, em O(n) no número de chaves. Retorna 0
+ * caso ela não exista. */
+int rjs_remove_key(rjs_parser_t *parser, const rjs_object_t *object, const char *name);
+
+/* Remove o elemento na posição dada, em O(pos). Retorna 0 caso ele não
+ * exista. */
+int rjs_remove_index(rjs_parser_t *parser, const rjs_object_t *object, rjs_size_t pos);
+
+/* Lê de novo o documento depois de uma edição no texto, reaproveitando o que
+ * não mudou. str é o texto novo, completo; na leitura anterior, os removed
+ * bytes a partir de start foram trocados pelos inserted bytes que agora
+ * estão em str a partir de start. Apenas o menor objeto ou array que contém
+ * a edição é lido de novo e posto no lugar do anterior, então o custo é
+ * proporcional ao tamanho desse objeto, e não ao do documento. Caso a edição
+ * mude a estrutura em volta dele, ou o documento tenha sido editado com as
+ * funções acima, ou tenha sido lido com RJS_FLAG_LAZY_NUMBERS (cujos números
+ * apontam para o texto anterior), o documento é lido por inteiro de novo, na
+ * memória que ele ocupava. Só o último documento é lido: os lidos antes dele com
+ * rjs_parse_document continuam válidos. A memória do objeto substituído só é
+ * devolvida na próxima leitura completa.
+ * Retorna 1 caso haja sucesso e 0 caso o texto novo seja inválido. O objeto
+ * principal pode mudar, e deve ser obtido de novo com rjs_get_main_object. */
+int rjs_reparse(rjs_parser_t *parser, const char *str, rjs_size_t start, rjs_size_t removed, rjs_size_t inserted);
+
+/* Entrada do índice de caminhos: a chave, o hash do seu caminho, a posição
+ * da entrada do pai mais 1 (0 no objeto principal) e, caso o pai seja uma
+ * array, a posição do elemento. */
+typedef struct {
+	const rjs_key_t *key;
+	rjs_size_t hash;
+	rjs_size_t parent;
+	rjs_size_t index;
+} rjs_path_entry_t;
+
+/* Índice de caminhos de um documento (veja rjs_build_index): uma tabela hash,
+ * com endereçamento aberto, de todos os caminhos do documento. */
+typedef struct {
+	rjs_parser_t *parser;
+	rjs_size_t generation;
+
+	rjs_path_entry_t *entries;
+	rjs_size_t capacity; /* Posições da tabela, uma potência de 2. */
+	rjs_size_t count; /* Chaves indexadas. */
+	rjs_size_t bytes; /* Memória usada pela tabela. */
+} rjs_path_index_t;
+
+/* Retorna quantos bytes rjs_build_index vai usar da memória do parser para
+ * indexar o documento lido, e escreve em keys quantas chaves serão indexadas,
+ * das quais depende o tempo de construção. Com isso, e a quantidade de buscas
+ * esperada, pode-se decidir se o índice vale a pena. */
+rjs_size_t rjs_index_size(rjs_parser_t *parser, rjs_size_t *keys);
+
+/* Indexa todos os caminhos do documento lido, em uma tabela alocada da
+ * memória do parser, para que rjs_index_get encontre qualquer caminho com uma
+ * busca na tabela, em vez de percorrer cada objeto do caminho. Retorna 0
+ * caso não haja documento ou memória. */
+int rjs_build_index(rjs_parser_t *parser, rjs_path_index_t *index);
+
+/* Como rjs_get_path a partir do objeto principal, mas usando o índice.
+ * Caso o documento tenha sido lido de novo ou editado depois da construção
+ * do índice, o caminho é percorrido chave a chave. */
+const rjs_key_t * rjs_index_get(const rjs_path_index_t *index, const char *path);
+
+/* Retorna 1 caso o índice ainda corresponda ao documento e 0 caso ele tenha
+ * sido lido de novo ou editado (com as funções de edição ou rjs_reparse). O
+ * índice não é atualizado pelas edições: depois delas, rjs_index_get percorre
+ * o caminho, e o índice deve ser construído de novo para voltar a ser usado. */
+int rjs_index_valid(const rjs_path_index_t *index);
+
+/* Converte o número em json que começa em str, com as mesmas regras do
+ * parser, e o escreve em number. O número termina em um espaço, vírgula,
+ * colchete ou chave. Retorna quantos caracteres foram lidos, ou 0 caso o
+ * número seja inválido. Usada pelos parsers gerados pelo rjs_gen. */
+rjs_size_t rjs_read_number(const char *str, double *number);
+
+/* Leitor de eventos.
+ *
+ * Em vez de montar o documento na memória, o leitor entrega um evento por
+ * vez (início e fim de objetos e arrays, chaves e valores), à medida que o
+ * usuário pede, e pode ler o texto em pedaços de qualquer tamanho. Assim é
+ * possível ler documentos maiores que a memória e parar a leitura assim que
+ * o que se procura for encontrado. */
+
+/* Resultados de rjs_reader_next. */
+#define RJS_READER_ERROR 0
+#define RJS_READER_DONE 1
+#define RJS_READER_EVENT 2
+#define RJS_READER_NEED_INPUT 3
+
+/* Tipos de evento. */
+enum rjs_event_type {
+	RJS_EVENT_BEGIN_OBJECT = 0,
+	RJS_EVENT_END_OBJECT,
+	RJS_EVENT_BEGIN_ARRAY,
+	RJS_EVENT_END_ARRAY,
+	RJS_EVENT_KEY,
+	RJS_EVENT_STRING,
+	RJS_EVENT_NUMBER,
+	RJS_EVENT_BOOLEAN,
+	RJS_EVENT_NULL
+};
+
+typedef struct {
+	/* O tipo, segundo a enumeração rjs_event_type. */
+	int type;
+
+	/* Texto das chaves e strings, já decodificado, e texto original dos
+	 * números. Quando possível, aponta para o próprio pedaço lido, e então
+	 * não termina em '\0'; use length. Só é válido até a próxima chamada de
+	 * rjs_reader_next ou rjs_reader_feed. */
+	const char *str;
+	rjs_size_t length;
+
+	double number;
+	int r_bool;
+
+	/* Quantidade de objetos e arrays abertos em volta do evento. O início e
+	 * o fim do objeto principal têm profundidade 0. */
+	int depth;
+} rjs_event_t;
+
+/* Estrutura que guarda o estado do leitor de eventos. */
+typedef struct {
+	/* Pedaço sendo lido, o seu tamanho e a posição atual. */
+	const char *input;
+	rjs_size_t input_size;
+	rjs_size_t input_index;
+	/* Indica que a entrada acabou (veja rjs_reader_feed). */
+	int input_end;
+
+	/* Memória do usuário para strings que não podem ser entregues direto
+	 * do pedaço lido: as que têm caracteres de controle ou que estão
+	 * divididas entre dois pedaços. */
+	char *buffer;
+	rjs_size_t buffer_size;
+	rjs_size_t buffer_pos;
+	/* Indica que a string atual está sendo copiada para o buffer, e onde
+	 * começa a parte dela que ainda não foi copiada. */
+	int copying;
+	rjs_size_t segment;
+
+	/* Texto do número sendo lido. */
+	char number[RJS_MAX_STRING_SIZE];
+	int number_pos;
+
+	/* Literal (true, false ou null) sendo lido e quantos bytes já foram
+	 * comparados. */
+	const char *literal;
+	int literal_pos;
+
+	/* Estado dos caracteres do tipo \uXXXX, como no parser. */
+	unsigned long unicode;
+	int unicode_digits;
+	unsigned long high_surrogate;
+
+	/* Indica, para cada objeto ou array aberto, se é uma array. */
+	unsigned char is_array[RJS_OBJECT_STACK_SIZE];
+	int depth;
+
+	/* Estado da máquina de estados e se a string atual é uma chave. */
+	int state;
+	int is_key;
+
+	/* Tipo do último evento entregue, usado por rjs_reader_skip. */
+	int last_event;
+
+	/* Estado do percurso feito por rjs_reader_skip: a profundidade que
+	 * falta fechar, se está dentro de uma string e se o próximo caractere
+	 * é escapado. skip_value indica que o próximo valor deve ser pulado. */
+	int skip_depth;
+	int skip_string;
+	int skip_escape;
+	int skip_value;
+
+	int line_count;
+	char error_log[RJS_MAX_STRING_SIZE];
+} rjs_reader_t;
+
+/* Cria o leitor. buffer é a memória usada para strings que precisam ser
+ * copiadas (veja rjs_event_t), e pode ser NULL caso o texto não tenha strings
+ * assim. Uma string que não caiba nele é um erro. Retorna 1. */
+int rjs_reader_create(rjs_reader_t *reader, char *buffer, rjs_size_t size);
+
+/* Entrega o próximo pedaço do texto, que deve continuar válido até que
+ * rjs_reader_next retorne RJS_READER_NEED_INPUT de novo. Um pedaço de tamanho
+ * 0 indica o fim do texto. Retorna 0 caso o pedaço anterior ainda não tenha
+ * sido lido por inteiro, e 1 em caso contrário. */
+int rjs_reader_feed(rjs_reader_t *reader, const char *chunk, rjs_size_t size);
+
+/* Lê o próximo evento e o escreve em event. Retorna RJS_READER_EVENT caso
+ * haja um evento, RJS_READER_NEED_INPUT caso o pedaço tenha acabado (chame
+ * rjs_reader_feed e depois esta função de novo), RJS_READER_DONE depois do
+ * fim do objeto principal e RJS_READER_ERROR caso haja um erro. O objeto
+ * principal pode ser um objeto ou uma array, e o que vier depois dele não é
+ * lido. */
+int rjs_reader_next(rjs_reader_t *reader, rjs_event_t *event);
+
+/* Pula o conteúdo do último evento: depois do início de um objeto ou array,
+ * pula tudo até o seu fim (sem entregar o evento de fim), e depois de uma
+ * chave, pula o seu valor. O conteúdo pulado é percorrido apenas contando
+ * aspas e colchetes, sem ser decodificado nem validado, e é pulado na
+ * próxima chamada de rjs_reader_next. Retorna 1 caso haja o que pular e 0
+ * em caso contrário. */
+int rjs_reader_skip(rjs_reader_t *reader);
+
+/* Retorna a mensagem de erro do leitor, caso haja. */
+const char * rjs_reader_get_error(rjs_reader_t *reader);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,104 @@
+#include "r_json_arena.hpp"
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <cstdint>
+
+/* Sem MADV_HUGEPAGE não há como pedir páginas grandes, e o mmap não traz
+ * vantagem sobre o operator new. */
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+#define RJS_HUGE_PAGES
+#endif
+
+namespace rjs {
+
+	/* HugePageAllocator */
+
+	namespace detail {
+		/* Tamanho das páginas grandes do x86-64 e do ARM64 com páginas de 4KB. */
+		static const std::size_t huge_page_size = 2 * 1024 * 1024;
+
+		void * huge_allocate(std::size_t size){
+#ifdef RJS_HUGE_PAGES
+			if(size >= huge_page_size){
+				std::size_t length = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+				/* Mapeia uma página a mais para alinhar o começo do bloco. */
+				void *map = mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				std::uintptr_t start, aligned;
+
+				if(map == MAP_FAILED)
+					throw std::bad_alloc();
+
+				start = (std::uintptr_t) map;
+				aligned = (start + huge_page_size - 1) & ~(std::uintptr_t) (huge_page_size - 1);
+
+				/* Devolve o que sobrou antes e depois do bloco alinhado. */
+				if(aligned > start)
+					munmap(map, aligned - start);
+
+				if(start + huge_page_size > aligned)
+					munmap((void *) (aligned + length), start + huge_page_size - aligned);
+
+				/* O kernel pode recusar (por exemplo, com as páginas grandes
+				 * desativadas), e então o bloco usa páginas comuns. */
+				madvise((void *) aligned, length, MADV_HUGEPAGE);
+
+				return (void *) aligned;
+			}
+#endif
+
+			return ::operator new(size);
+		}
+
+		void huge_deallocate(void *block, std::size_t size){
+#ifdef RJS_HUGE_PAGES
+			if(size >= huge_page_size){
+				munmap(block, (size + huge_page_size - 1) & ~(huge_page_size - 1));
+				return;
+			}
+#endif
+
+			::operator delete(block);
+		}
+	};
+
+#if __cplusplus >= 201703L
+	/* HugePageResource */
+
+	void * HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment){
+		/* O operator new e o mmap já alinham para qualquer tipo comum. */
+		(void) alignment;
+
+		return detail::huge_allocate(bytes);
+	}
+
+	void HugePageResource::do_deallocate(void *block, std::size_t bytes, std::size_t alignment){
+		(void) alignment;
+
+		detail::huge_deallocate(block, bytes);
+	}
+
+	bool HugePageResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+		return dynamic_cast<const HugePageResource *>(&other) != nullptr;
+	}
+#endif
+};
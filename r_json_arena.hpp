@@ -0,0 +1,247 @@
+#ifndef R_JSON_ARENA_HPP
+#define R_JSON_ARENA_HPP
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Parser de C++ que é dono da sua memória. Fica fora da r_json_plus.hpp, pois
+ * usa alocadores da standard library e, no Linux, mmap. Exemplo:
+ *
+ *	rjs::ArenaParser parser(1 << 20);
+ *
+ *	if(parser.parse(str))
+ *		std::cout << parser.getMainObject()["x"].get<int>() << '\n';
+ *
+ * A memória cresce quando um documento não cabe nela, e é reaproveitada entre
+ * as leituras. */
+
+#include "r_json_plus.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+
+namespace rjs {
+	namespace detail {
+		/* Alocam e liberam blocos para o HugePageAllocator. Blocos grandes
+		 * vêm do mmap, alinhados a 2MB e marcados com MADV_HUGEPAGE, e os
+		 * pequenos (ou em sistemas sem mmap) vêm do operator new. */
+		void * huge_allocate(std::size_t size);
+		void huge_deallocate(void *block, std::size_t size);
+	};
+
+	/* Alocador que usa páginas grandes (transparent huge pages) para blocos
+	 * a partir de 2MB, diminuindo as falhas de TLB ao percorrer documentos de
+	 * centenas de MB. O kernel pode ignorar o pedido, e então as páginas
+	 * comuns são usadas. */
+	template <typename T>
+	class HugePageAllocator {
+		public:
+			typedef T value_type;
+
+			HugePageAllocator(void) noexcept {}
+
+			template <typename U>
+			HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+			T * allocate(std::size_t n){
+				return static_cast<T *>(detail::huge_allocate(n * sizeof(T)));
+			}
+
+			void deallocate(T *block, std::size_t n){
+				detail::huge_deallocate(block, n * sizeof(T));
+			}
+	};
+
+	template <typename T, typename U>
+	bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &){
+		return true;
+	}
+
+	template <typename T, typename U>
+	bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &){
+		return false;
+	}
+
+	/* Parser com a memória alocada por Allocator (um alocador de char). A
+	 * memória é liberada na destruição, e o parser pode ser movido, mas não
+	 * copiado. Objetos e chaves lidos continuam pertencendo à memória do
+	 * parser, e são invalidados pela próxima leitura, por reset e quando a
+	 * memória cresce. */
+	template <typename Allocator = std::allocator<char> >
+	class BasicArenaParser : public Parser {
+		private:
+			typedef std::allocator_traits<Allocator> Traits;
+
+			/* A memória e o alocador que a criou, que andam juntos quando o
+			 * parser é movido. Assim alocadores que não podem ser atribuídos
+			 * (como o std::pmr::polymorphic_allocator) também funcionam. */
+			struct Arena {
+				Allocator allocator;
+				char *block;
+				rjs_size_t size;
+
+				Arena(const Allocator &allocator, rjs_size_t size) : allocator(allocator) {
+					this->block = Traits::allocate(this->allocator, size);
+					this->size = size;
+				}
+
+				~Arena(void){
+					Traits::deallocate(allocator, block, size);
+				}
+			};
+
+			std::unique_ptr<Arena> arena;
+			rjs_size_t max_size;
+
+			BasicArenaParser(Arena *arena, rjs_size_t max_size) : Parser(arena->block, arena->size), arena(arena) {
+				this->max_size = max_size;
+			}
+
+			/* Deixa o parser sem memória, após ela ter sido movida. */
+			void detach(void){
+				parser.memory.block = nullptr;
+				parser.memory.size = 0;
+				parser.memory.top = 0;
+				parser.memory.string_top = 0;
+				parser.document_top = 0;
+				parser.document_string_top = 0;
+				parser.start_object = nullptr;
+			}
+
+		public:
+			/* Cria o parser com size bytes de memória, alocados por allocator. */
+			explicit BasicArenaParser(rjs_size_t size, const Allocator &allocator = Allocator()) :
+				BasicArenaParser(new Arena(allocator, size), (rjs_size_t) -1) {
+			}
+
+			BasicArenaParser(const BasicArenaParser &) = delete;
+			BasicArenaParser & operator=(const BasicArenaParser &) = delete;
+
+			BasicArenaParser(BasicArenaParser &&other) noexcept : Parser(other), arena(std::move(other.arena)) {
+				max_size = other.max_size;
+				other.detach();
+			}
+
+			BasicArenaParser & operator=(BasicArenaParser &&other) noexcept {
+				if(this != &other){
+					Parser::operator=(other);
+					arena = std::move(other.arena);
+					max_size = other.max_size;
+					other.detach();
+				}
+
+				return *this;
+			}
+
+			/* Decodifica uma string. Caso falte memória, a memória cresce
+			 * (até o limite de setMaxSize) e a string é lida de novo.
+			 * Retorna true caso haja sucesso. */
+			bool parse(const char *str){
+				while(!Parser::parse(str)){
+					if(!parser.out_of_memory_flag || !grow(std::strlen(str)))
+						return false;
+				}
+
+				return true;
+			}
+
+			/* Descarta o documento lido, mantendo a memória para a próxima
+			 * leitura. Não percorre a memória. */
+			void reset(void){
+				rjs_clean_parser(&parser);
+			}
+
+			/* Troca a memória por uma maior, de pelo menos o dobro do tamanho
+			 * atual e de quatro vezes hint (o tamanho do próximo documento),
+			 * descartando o documento lido. As flags, as estatísticas e o
+			 * filtro são mantidos. Retorna false caso o limite de setMaxSize seja
+			 * alcançado ou o parser tenha sido movido. */
+			bool grow(rjs_size_t hint = 0){
+				rjs_size_t size;
+				int flags = parser.flags;
+				rjs_parse_stats_t *stats = parser.stats;
+				const rjs_predicate_t *filters = parser.filters;
+				int filter_count = parser.filter_count;
+				int filter_depth = parser.filter_depth;
+				rjs_size_t generation = parser.generation;
+
+				if(!arena || arena->size >= max_size)
+					return false;
+
+				size = arena->size * 2 > hint * 4 ? arena->size * 2 : hint * 4;
+
+				/* Caso a conta passe do maior valor possível. */
+				if(size <= arena->size || size > max_size)
+					size = max_size;
+
+				arena.reset(new Arena(arena->allocator, size));
+
+				rjs_create_parser(&parser, arena->block, arena->size);
+				rjs_set_flags(&parser, flags);
+				rjs_set_stats(&parser, stats);
+
+				/* Um índice da memória anterior não pode parecer atual: a sua
+				 * tabela estava na memória descartada. */
+				parser.generation = generation + 1;
+
+				if(filter_count != 0)
+					rjs_set_filter(&parser, filters, filter_count, filter_depth);
+
+				return true;
+			}
+
+			/* Define o tamanho máximo que a memória pode alcançar ao crescer.
+			 * Com o tamanho atual, a memória não cresce. Por padrão, não há
+			 * limite. */
+			void setMaxSize(rjs_size_t size){
+				max_size = size;
+			}
+
+			/* Retorna o tamanho da memória. */
+			rjs_size_t capacity(void) const {
+				return arena ? arena->size : 0;
+			}
+	};
+
+	typedef BasicArenaParser<> ArenaParser;
+	typedef BasicArenaParser<HugePageAllocator<char> > HugePageParser;
+
+#if __cplusplus >= 201703L
+	/* memory_resource que usa as mesmas páginas grandes do HugePageAllocator. */
+	class HugePageResource : public std::pmr::memory_resource {
+		private:
+			void * do_allocate(std::size_t bytes, std::size_t alignment) override;
+			void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+	};
+
+	namespace pmr {
+		/* Parser com a memória vinda de um std::pmr::memory_resource.
+		 * Exemplo: rjs::pmr::ArenaParser parser(size, &resource); */
+		typedef BasicArenaParser<std::pmr::polymorphic_allocator<char> > ArenaParser;
+	};
+#endif
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "r_json_gzip.hpp"
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+#include <zlib.h>
+
+namespace rjs {
+
+	/* GzipSource */
+
+	GzipSource::GzipSource(std::FILE *file, std::size_t chunk_size, std::size_t chunks) : file(file), data(nullptr), data_size(0) {
+		start(chunk_size, chunks);
+	}
+
+	GzipSource::GzipSource(const char *data, std::size_t size, std::size_t chunk_size, std::size_t chunks) : file(nullptr), data(data), data_size(size) {
+		start(chunk_size, chunks);
+	}
+
+	GzipSource::~GzipSource(void){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+
+		consumed.notify_one();
+		worker.join();
+	}
+
+	void GzipSource::start(std::size_t chunk_size, std::size_t chunks){
+		buffers.resize(chunks == 0 ? 1 : chunks);
+		sizes.resize(buffers.size());
+
+		for(std::size_t i = 0; i < buffers.size(); i++)
+			buffers[i].resize(chunk_size == 0 ? 1 : chunk_size);
+
+		head = filled = 0;
+		held = done = stop = false;
+		error = nullptr;
+
+		worker = std::thread(&GzipSource::run, this);
+	}
+
+	bool GzipSource::next(const char **chunk, std::size_t *size){
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if(held){
+			held = false;
+			head = (head + 1) % buffers.size();
+			filled--;
+			consumed.notify_one();
+		}
+
+		produced.wait(lock, [this](){ return filled != 0 || done; });
+
+		if(filled == 0){
+			*chunk = buffers[0].data();
+			*size = 0;
+			return false;
+		}
+
+		held = true;
+		*chunk = buffers[head].data();
+		*size = sizes[head];
+
+		return true;
+	}
+
+	bool GzipSource::failed(void){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return error != nullptr;
+	}
+
+	const char * GzipSource::getError(void){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return error == nullptr ? "" : error;
+	}
+
+#if __cplusplus >= 201703L
+	std::string_view GzipSource::operator()(void){
+		const char *chunk;
+		std::size_t size;
+
+		next(&chunk, &size);
+
+		return std::string_view(chunk, size);
+	}
+#endif
+
+	void GzipSource::finish(const char *message){
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			error = message;
+			done = true;
+		}
+
+		produced.notify_one();
+	}
+
+	void GzipSource::run(void){
+		std::vector<unsigned char> input(file != nullptr ? buffers[0].size() : 0);
+		std::size_t position = 0;
+		bool member_end = false;
+		z_stream stream;
+
+		stream.zalloc = Z_NULL;
+		stream.zfree = Z_NULL;
+		stream.opaque = Z_NULL;
+		stream.next_in = Z_NULL;
+		stream.avail_in = 0;
+
+		/* 15 + 32: janela máxima, com detecção de cabeçalho gzip ou zlib. */
+		if(inflateInit2(&stream, 15 + 32) != Z_OK){
+			finish("Out of memory.");
+			return;
+		}
+
+		for(;;){
+			const char *message = nullptr;
+			bool end = false;
+			std::size_t slot;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				consumed.wait(lock, [this](){ return filled < buffers.size() || stop; });
+
+				if(stop)
+					break;
+
+				slot = (head + filled) % buffers.size();
+			}
+
+			std::vector<char> &out = buffers[slot];
+
+			stream.next_out = (Bytef *) out.data();
+			stream.avail_out = (uInt) out.size();
+
+			while(stream.avail_out != 0){
+				if(stream.avail_in == 0){
+					/* A entrada na memória é dada em partes que caibam em
+					 * um uInt. */
+					if(file != nullptr){
+						stream.next_in = input.data();
+						stream.avail_in = (uInt) std::fread(input.data(), 1, input.size(), file);
+
+						if(stream.avail_in == 0 && std::ferror(file)){
+							message = "Error while reading file.";
+							break;
+						}
+					}
+					else{
+						std::size_t piece = data_size - position < (1U << 30) ? data_size - position : (1U << 30);
+
+						stream.next_in = (Bytef *) (data + position);
+						stream.avail_in = (uInt) piece;
+						position += piece;
+					}
+
+					if(stream.avail_in == 0){
+						if(member_end)
+							end = true;
+						else
+							message = "Truncated gzip data.";
+
+						break;
+					}
+				}
+
+				/* Há mais dados depois do fim de um membro: o próximo. */
+				if(member_end){
+					inflateReset(&stream);
+					member_end = false;
+				}
+
+				int status = inflate(&stream, Z_NO_FLUSH);
+
+				if(status == Z_STREAM_END){
+					member_end = true;
+				}
+				else if(status == Z_MEM_ERROR){
+					message = "Out of memory.";
+					break;
+				}
+				else if(status != Z_OK && status != Z_BUF_ERROR){
+					message = "Invalid gzip data.";
+					break;
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				sizes[slot] = out.size() - stream.avail_out;
+
+				if(sizes[slot] != 0)
+					filled++;
+			}
+
+			produced.notify_one();
+
+			if(end || message != nullptr){
+				inflateEnd(&stream);
+				finish(message);
+				return;
+			}
+		}
+
+		inflateEnd(&stream);
+	}
+};
@@ -0,0 +1,121 @@
+#ifndef R_JSON_GZIP_HPP
+#define R_JSON_GZIP_HPP
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Leitura de textos compactados com gzip (ou zlib), descompactados em uma
+ * segunda thread enquanto o leitor de eventos lê os pedaços já prontos. Fica
+ * fora da r_json.h, pois depende da zlib (-lz) e de threads da standard
+ * library de C++. Exemplo:
+ *
+ *	rjs::GzipSource source(file);
+ *	const char *chunk;
+ *	std::size_t size;
+ *
+ *	while((status = rjs_reader_next(&reader, &event)) != RJS_READER_DONE){
+ *		if(status == RJS_READER_NEED_INPUT){
+ *			source.next(&chunk, &size);
+ *			rjs_reader_feed(&reader, chunk, size);
+ *		}
+ *		...
+ *	}
+ *
+ * Em C++17, a fonte também pode ser dada ao rjs::PullParser, com
+ * std::ref(source). */
+
+#include "r_json.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace rjs {
+	/* Texto descompactado em pedaços por uma segunda thread. A memória é
+	 * limitada a chunks pedaços de chunk_size bytes: a thread espera enquanto
+	 * todos estiverem cheios ou com o leitor. Arquivos com vários membros
+	 * (gzip concatenados) são lidos como um só texto. */
+	class GzipSource {
+		private:
+			std::vector<std::vector<char> > buffers;
+			std::vector<std::size_t> sizes;
+
+			/* Próximo pedaço a ser entregue, a quantidade de pedaços cheios
+			 * (contando o que está com o leitor) e se o leitor tem um. */
+			std::size_t head;
+			std::size_t filled;
+			bool held;
+
+			/* A descompactação terminou, ou o objeto está sendo destruído. */
+			bool done;
+			bool stop;
+			const char *error;
+
+			/* Origem do texto compactado: um arquivo ou a memória. */
+			std::FILE *file;
+			const char *data;
+			std::size_t data_size;
+
+			std::mutex mutex;
+			std::condition_variable produced;
+			std::condition_variable consumed;
+			std::thread worker;
+
+			void start(std::size_t chunk_size, std::size_t chunks);
+			/* Laço da segunda thread. */
+			void run(void);
+			/* Termina a descompactação, com a mensagem de erro dada ou NULL. */
+			void finish(const char *message);
+
+		public:
+			/* Lê o texto compactado do arquivo aberto file, que deve continuar
+			 * aberto até o fim da leitura e é fechado por quem o abriu. */
+			GzipSource(std::FILE *file, std::size_t chunk_size = 1 << 16, std::size_t chunks = 4);
+			/* Lê os size bytes compactados em data, que devem continuar válidos
+			 * até o fim da leitura. */
+			GzipSource(const char *data, std::size_t size, std::size_t chunk_size = 1 << 16, std::size_t chunks = 4);
+			/* Para a descompactação, caso não tenha terminado. */
+			~GzipSource(void);
+
+			GzipSource(const GzipSource &) = delete;
+			GzipSource & operator=(const GzipSource &) = delete;
+
+			/* Devolve o pedaço anterior e espera o próximo, que fica válido até
+			 * a próxima chamada. Retorna false, com um pedaço vazio, no fim do
+			 * texto ou caso haja um erro (veja failed). */
+			bool next(const char **chunk, std::size_t *size);
+			/* Retorna true caso os dados compactados sejam inválidos,
+			 * estejam cortados ou não possam ser lidos. */
+			bool failed(void);
+			/* Retorna a mensagem de erro, ou uma string vazia. */
+			const char * getError(void);
+
+#if __cplusplus >= 201703L
+			/* Retorna o próximo pedaço, para uso como PullParser::Source. */
+			std::string_view operator()(void);
+#endif
+	};
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "r_json_plus.hpp"
 #include <iostream>
+#include <limits>
 
 /*
  *	  This file is part of r_json.
@@ -20,8 +21,95 @@
 
 namespace rjs {
 
+	/* NumberView */
+
+	NumberView::NumberView(const double *numbers, rjs_size_t length){
+		this->numbers = numbers;
+		this->length = numbers != nullptr ? length : 0;
+	}
+
+	bool NumberView::isValid(void) const {
+		return rjs_isvalid((const void *) numbers);
+	}
+
+	const double * NumberView::data(void) const {
+		return numbers;
+	}
+
+	rjs_size_t NumberView::size(void) const {
+		return length;
+	}
+
+	const double * NumberView::begin(void) const {
+		return numbers;
+	}
+
+	const double * NumberView::end(void) const {
+		return numbers + length;
+	}
+
+	double NumberView::operator[](rjs_size_t index) const {
+		return numbers[index];
+	}
+
 	/* Key */
 
+	/* Lê um inteiro exato a partir do texto de um número preguiçoso
+	 * (veja RJS_FLAG_LAZY_NUMBERS). Retorna false caso o texto não seja
+	 * um inteiro representável em T, e então o chamador usa o double. */
+	template <typename T>
+	static bool read_integer(const rjs_key_t *key, T &ret){
+		rjs_size_t length;
+		const char *raw = rjs_get_vraw(key, &length);
+		const char *end;
+		T number = 0;
+		bool negative = false;
+
+		if(raw == nullptr)
+			return false;
+
+		end = raw + length;
+
+		if(*raw == '-'){
+			/* Inteiros sem sinal não recebem negativos. */
+			if(!std::numeric_limits<T>::is_signed)
+				return false;
+
+			negative = true;
+			raw++;
+		}
+
+		if(raw == end)
+			return false;
+
+		for(; raw != end; raw++){
+			T digit;
+
+			if(*raw < '0' || *raw > '9')
+				return false;
+
+			digit = T(*raw - '0');
+
+			/* Acumula negativo para alcançar o menor valor do tipo. */
+			if(negative){
+				if(number < (std::numeric_limits<T>::min() + digit) / 10)
+					return false;
+
+				number = number * 10 - digit;
+			}
+			else{
+				if(number > (std::numeric_limits<T>::max() - digit) / 10)
+					return false;
+
+				number = number * 10 + digit;
+			}
+		}
+
+		ret = number;
+
+		return true;
+	}
+
 	Key::Key(const rjs_key_t *key){
 		this->key = key;
 	}
@@ -53,6 +141,13 @@ namespace rjs {
 		return key->value.type;
 	}
 	
+	const char * Key::getRaw(rjs_size_t *length){
+		if(!isValid())
+			return nullptr;
+
+		return rjs_get_vraw(key, length);
+	}
+
 	string Key::getTypeName(void){
 		if(!isValid())
 			return nullptr;
@@ -99,6 +194,11 @@ namespace rjs {
 	template <>
 	long Key::get<long>(void){
 		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			long number;
+
+			if(read_integer(key, number))
+				return number;
+
 			return (long) rjs_get_vnumber(key);
 		}
 
@@ -108,12 +208,45 @@ namespace rjs {
 	template <>
 	unsigned long Key::get<unsigned long>(void){
 		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			unsigned long number;
+
+			if(read_integer(key, number))
+				return number;
+
 			return (unsigned long) rjs_get_vnumber(key);
 		}
 
 		return 0;
 	}
 
+	template <>
+	long long Key::get<long long>(void){
+		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			long long number;
+
+			if(read_integer(key, number))
+				return number;
+
+			return (long long) rjs_get_vnumber(key);
+		}
+
+		return 0;
+	}
+
+	template <>
+	unsigned long long Key::get<unsigned long long>(void){
+		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			unsigned long long number;
+
+			if(read_integer(key, number))
+				return number;
+
+			return (unsigned long long) rjs_get_vnumber(key);
+		}
+
+		return 0;
+	}
+
 	template <>
 	const char * Key::get<const char *>(void){
 		if(rjs_istype(key, RJS_KEY_STRING)){
@@ -155,6 +288,17 @@ namespace rjs {
 		return object->is_array;
 	}
 
+	rjs_size_t Object::size(void){
+		return rjs_get_length(object);
+	}
+
+	NumberView Object::getNumbers(void){
+		rjs_size_t length;
+		const double *numbers = rjs_get_numbers(object, &length);
+
+		return NumberView(numbers, length);
+	}
+
 	Key Object::operator[](rjs_size_t index){
 		return Key(rjs_get_key_index(object, index));
 	}
@@ -167,10 +311,15 @@ namespace rjs {
 		return Key(rjs_get_key(object, str));
 	}
 
+	Key Object::find(const char *path){
+		return Key(rjs_get_path(object, path));
+	}
+
 	/* Parser */
 
 	Parser::Parser(void *block, rjs_size_t size){
 		rjs_create_parser(&parser, (char *) block, size);
+		index.parser = nullptr;
 	}
 
 	Object Parser::getMainObject(void){
@@ -181,8 +330,142 @@ namespace rjs {
 		return rjs_parse_string(&parser, str);
 	}
 
+	Object Parser::parseDocument(const char *str){
+		return Object(rjs_parse_document(&parser, str));
+	}
+
+	rjs_mark_t Parser::mark(void){
+		/* Uma marca além da memória, recusada por rollback caso rjs_mark
+		 * falhe. */
+		rjs_mark_t mark = { (rjs_size_t) -1, 0, nullptr, RJS_PARSE_ERROR, 0, 0, 0 };
+
+		rjs_mark(&parser, &mark);
+
+		return mark;
+	}
+
+	bool Parser::rollback(const rjs_mark_t &mark){
+		return rjs_rollback(&parser, &mark);
+	}
+
+	bool Parser::begin(const char *str){
+		return rjs_parse_begin(&parser, str);
+	}
+
+	int Parser::step(rjs_size_t max_bytes){
+		return rjs_parse_step_budget(&parser, max_bytes);
+	}
+
 	const char * Parser::getError(){
 		return rjs_get_error(&parser);
 	}
 
+	const rjs_error_t & Parser::getErrorInfo(){
+		return *rjs_get_error_info(&parser);
+	}
+
+	void Parser::setFlags(int flags){
+		rjs_set_flags(&parser, flags);
+	}
+
+	void Parser::setStats(rjs_parse_stats_t *stats){
+		rjs_set_stats(&parser, stats);
+	}
+
+	bool Parser::setFilter(const rjs_predicate_t *predicates, int n, int depth){
+		return rjs_set_filter(&parser, predicates, n, depth) == 1;
+	}
+
+	rjs_size_t Parser::getRejected(void){
+		return rjs_get_rejected(&parser);
+	}
+
+	rjs_size_t Parser::indexSize(rjs_size_t *keys){
+		rjs_size_t count;
+		rjs_size_t size = rjs_index_size(&parser, &count);
+
+		if(keys != nullptr)
+			*keys = count;
+
+		return size;
+	}
+
+	bool Parser::buildIndex(void){
+		return rjs_build_index(&parser, &index);
+	}
+
+	Key Parser::find(const char *path){
+		/* Um parser copiado ou movido tem o índice do original. */
+		if(index.parser != &parser)
+			return Key(rjs_get_path(parser.start_object, path));
+
+		return Key(rjs_index_get(&index, path));
+	}
+
+	bool Parser::indexValid(void){
+		return index.parser == &parser && rjs_index_valid(&index);
+	}
+
+	rjs_size_t Parser::compactSize(void){
+		return rjs_compact_size(&parser);
+	}
+
+	Object Parser::compact(void *block, rjs_size_t size){
+		return Object(rjs_compact(&parser, (char *) block, size));
+	}
+
+	double Parser::cacheNumber(Key key){
+		if(!rjs_istype(key.key, RJS_KEY_NUMBER))
+			return 0;
+
+		return rjs_cache_number(&parser, key.key);
+	}
+
+	Object Parser::newObject(bool is_array){
+		return Object(rjs_new_object(&parser, is_array));
+	}
+
+	bool Parser::setNumber(Key key, double number){
+		return rjs_set_number(&parser, key.key, number);
+	}
+
+	bool Parser::setString(Key key, const char *str){
+		return rjs_set_string(&parser, key.key, str);
+	}
+
+	bool Parser::setBool(Key key, bool value){
+		return rjs_set_bool(&parser, key.key, value);
+	}
+
+	bool Parser::setNull(Key key){
+		return rjs_set_null(&parser, key.key);
+	}
+
+	bool Parser::setObject(Key key, Object object){
+		return rjs_set_object(&parser, key.key, object.object);
+	}
+
+	Key Parser::insert(Object object, const char *name){
+		return Key(rjs_insert_key(&parser, object.object, name));
+	}
+
+	Key Parser::append(Object array){
+		if(array.object == nullptr || !array.object->is_array)
+			return Key(nullptr);
+
+		return Key(rjs_insert_key(&parser, array.object, nullptr));
+	}
+
+	Key Parser::append(Object object, const char *name){
+		return Key(rjs_append_key(&parser, object.object, name));
+	}
+
+	bool Parser::remove(Object object, const char *name){
+		return rjs_remove_key(&parser, object.object, name);
+	}
+
+	bool Parser::remove(Object array, rjs_size_t index){
+		return rjs_remove_index(&parser, array.object, index);
+	}
+
 };
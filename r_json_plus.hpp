@@ -20,12 +20,53 @@
 
 #include "r_json.h"
 
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
 namespace rjs {
 	/* Para facilitar a escrita. */
 	typedef const char * string;
 
 	class Object;
 
+	namespace detail {
+		struct StaticAccess;
+		struct Visit;
+	};
+
+	/* Marca o fim de um objeto ou array em Object::walk. */
+	struct End {};
+
+	/* Visão dos números de uma array compactada (veja RJS_FLAG_PACK_NUMBERS).
+	 * Os números continuam pertencendo à memória do parser. */
+	class NumberView {
+		private:
+			const double *numbers;
+			rjs_size_t length;
+
+			NumberView(const double *numbers, rjs_size_t length);
+
+		public:
+			/* Retorna true caso a array tenha sido compactada. */
+			bool isValid(void) const;
+			const double * data(void) const;
+			rjs_size_t size(void) const;
+			const double * begin(void) const;
+			const double * end(void) const;
+			double operator[](rjs_size_t index) const;
+
+		friend class Object;
+	};
+
 	class Key {
 		private:
 			Key(const rjs_key_t *key);
@@ -59,8 +100,19 @@ namespace rjs {
 			/* Retorna o nome do tipo. */
 			string getTypeName(void);
 
+			/* Retorna o texto original do número quando lido com
+			 * RJS_FLAG_LAZY_NUMBERS, ou nullptr, e escreve o seu tamanho em
+			 * length (o texto não termina em '\0'; veja rjs_get_vraw). Os
+			 * tipos inteiros de 64 bits de get usam esse texto e não perdem
+			 * precisão. */
+			const char * getRaw(rjs_size_t *length = nullptr);
 
 		friend class Object;
+		friend class Parser;
+		friend struct detail::Visit;
+
+		template <typename... T, typename... Names>
+		friend std::tuple<std::vector<T>...> columns(Object array, Names... names);
 	};
 
 	class Object {
@@ -74,22 +126,383 @@ namespace rjs {
 			Key operator[](int index);
 			/* Retorna a chave dada pela string str. */
 			Key operator[](const char *str);
+			/* Retorna a chave no caminho dado a partir do objeto, como
+			 * "/user/name" (veja rjs_get_path). */
+			Key find(const char *path);
+			/* Retorna as chaves com os nomes dados, buscadas em um único
+			 * percurso do objeto (veja rjs_get_keys). Exemplo:
+			 * auto keys = obj.get("id", "name", "active"); */
+			template <typename... Names>
+			std::array<Key, sizeof...(Names)> get(Names... names){
+				const char *list[] = { names... };
+				const rjs_key_t *keys[sizeof...(Names)];
+				rjs_size_t i = 0;
+
+				rjs_get_keys(object, list, sizeof...(Names), keys);
+
+				/* A lista é avaliada em ordem, então cada nome recebe a sua chave. */
+				return std::array<Key, sizeof...(Names)>{{ ((void) names, Key(keys[i++]))... }};
+			}
 			/* Retorna true caso o objeto seja válido. */
 			bool isValid(void);
 			/* Retorna true caso o objeto seja uma array. */
 			bool isArray(void);
+			/* Retorna a quantidade de elementos. */
+			rjs_size_t size(void);
+			/* Retorna os números de uma array compactada. Caso ela não
+			 * tenha sido compactada, a visão será inválida. */
+			NumberView getNumbers(void);
+			/* Percorre todos os elementos dentro do objeto, em profundidade,
+			 * chamando visitor(nome, valor) para cada um, com o valor já no
+			 * seu tipo (veja rjs::visit). Objetos e arrays internos são
+			 * visitados ao entrar, com rjs::Object, e ao sair, com rjs::End.
+			 * O nome é nullptr em elementos de arrays. O percurso usa uma
+			 * pilha própria, e não a recursão. */
+			template <typename Visitor>
+			void walk(Visitor &&visitor);
+			/* Copia até n elementos da array para dst, percorrendo-a uma
+			 * vez. T pode ser um tipo numérico, bool, const char *,
+			 * std::string, std::string_view ou rjs::Object. A cópia para no
+			 * primeiro elemento que não seja do tipo de T, em vez de
+			 * preenchê-lo com zero como Key::get. Retorna quantos elementos
+			 * foram copiados; um valor menor que size() indica a posição do
+			 * elemento de outro tipo. */
+			template <typename T>
+			rjs_size_t copyTo(T *dst, rjs_size_t n);
+			/* Retorna um container (std::vector<float>, por exemplo) com os
+			 * elementos da array, copiados como em copyTo. Caso haja um
+			 * elemento de outro tipo, o container terá menos elementos que
+			 * size(). */
+			template <typename Container>
+			Container to(void);
 		
 		friend class Parser;
 		friend class Key;
+		friend struct detail::StaticAccess;
+		friend struct detail::Visit;
+
+		template <typename... T, typename... Names>
+		friend std::tuple<std::vector<T>...> columns(Object array, Names... names);
+	};
+
+
+	template <> double Key::get<double>(void);
+	template <> float Key::get<float>(void);
+	template <> int Key::get<int>(void);
+	template <> unsigned int Key::get<unsigned int>(void);
+	template <> long Key::get<long>(void);
+	template <> unsigned long Key::get<unsigned long>(void);
+	template <> long long Key::get<long long>(void);
+	template <> unsigned long long Key::get<unsigned long long>(void);
+	template <> const char * Key::get<const char *>(void);
+	template <> bool Key::get<bool>(void);
+	template <> Object Key::get<Object>(void);
+
+	namespace detail {
+		/* Escreve o valor da chave na coluna de índice column da tupla. */
+		template <rjs_size_t I, rjs_size_t N, typename Tuple>
+		struct ColumnPusher {
+			static void push(Tuple &columns, rjs_size_t column, Key &key){
+				if(column == I){
+					typedef typename std::tuple_element<I, Tuple>::type Column;
+					std::get<I>(columns).push_back(key.get<typename Column::value_type>());
+				}
+				else{
+					ColumnPusher<I + 1, N, Tuple>::push(columns, column, key);
+				}
+			}
+		};
+
+		template <rjs_size_t N, typename Tuple>
+		struct ColumnPusher<N, N, Tuple> {
+			static void push(Tuple &, rjs_size_t, Key &){
+			}
+		};
 	};
 
+	/* Extrai colunas de uma array de objetos, percorrendo-a apenas uma vez.
+	 * Exemplo: rjs::columns<double, double, long>(array, "ts", "lat", "lon").
+	 * As chaves são buscadas com rjs_get_key_from, como em
+	 * rjs_extract_columns, então objetos com as chaves na mesma ordem custam
+	 * uma comparação por chave. Diferente de rjs_extract_columns, que falha,
+	 * chaves ausentes (e elementos que não são objetos) são preenchidas como
+	 * em Key::get, para manter as colunas alinhadas. Caso array não seja uma
+	 * array de objetos, as colunas ficam vazias. */
+	template <typename... T, typename... Names>
+	std::tuple<std::vector<T>...> columns(Object array, Names... names){
+		static_assert(sizeof...(T) == sizeof...(Names), "Cada coluna precisa de um nome.");
+
+		typedef std::tuple<std::vector<T>...> Columns;
+		const char *fields[] = { names... };
+		Columns result;
+
+		if(!array.isValid() || !array.object->is_array || array.object->numbers != NULL)
+			return result;
+
+		for(const rjs_key_t *row = array.object->start_key; row != NULL; row = row->next){
+			const rjs_object_t *object = NULL;
+			const rjs_key_t *cursor = NULL;
+
+			if(rjs_istype(row, RJS_KEY_OBJECT))
+				object = rjs_get_vobj(row);
+
+			for(rjs_size_t i = 0; i < sizeof...(T); i++){
+				Key column_key(rjs_get_key_from(object, &cursor, fields[i]));
+				detail::ColumnPusher<0, sizeof...(T), Columns>::push(result, i, column_key);
+			}
+		}
+
+		return result;
+	}
+
+	namespace detail {
+		/* Chama o visitor com o nome dado antes do valor. */
+		template <typename Visitor>
+		struct Named {
+			Visitor &visitor;
+			const char *name;
+
+			template <typename T>
+			auto operator()(T value) -> decltype(visitor(name, value)) {
+				return visitor(name, value);
+			}
+		};
+
+		struct Visit {
+			static Object object(const rjs_object_t *object){
+				return Object(object);
+			}
+
+			/* Chama o visitor com o valor da chave, lendo o tipo uma vez. */
+			template <typename Visitor>
+			static auto value(const rjs_key_t *key, Visitor &visitor) -> decltype(visitor(nullptr)) {
+				if(key == nullptr)
+					return visitor(nullptr);
+
+				switch(key->value.type){
+					case RJS_KEY_STRING:
+						return visitor(key->value.data.str);
+					case RJS_KEY_NUMBER:
+						return visitor(rjs_get_vnumber(key));
+					case RJS_KEY_BOOLEAN:
+						return visitor(key->value.data.r_bool != 0);
+					case RJS_KEY_OBJECT:
+						return visitor(Object(key->value.data.obj));
+					default:
+						return visitor(nullptr);
+				}
+			}
+
+			template <typename Visitor>
+			static auto value(Key key, Visitor &visitor) -> decltype(visitor(nullptr)) {
+				return value(key.key, visitor);
+			}
+
+			template <typename Visitor>
+			static void walk(const rjs_object_t *root, Visitor &visitor){
+				struct Frame {
+					const rjs_object_t *object;
+					const rjs_key_t *key;
+					rjs_size_t index;
+					const char *name;
+				};
+
+				std::vector<Frame> stack;
+
+				if(root == nullptr)
+					return;
+
+				stack.push_back(Frame{root, root->start_key, 0, nullptr});
 
-	template <>
-	Object Key::get<Object>(void);
+				while(!stack.empty()){
+					Frame &frame = stack.back();
+
+					/* Arrays compactadas não têm chaves, só os números. */
+					if(frame.object->numbers != nullptr && frame.index < frame.object->length){
+						visitor((const char *) nullptr, frame.object->numbers[frame.index++]);
+					}
+					else if(frame.key != nullptr){
+						const rjs_key_t *key = frame.key;
+
+						frame.key = key->next;
+
+						if(key->value.type == RJS_KEY_OBJECT){
+							const rjs_object_t *child = key->value.data.obj;
+
+							visitor(key->name, Object(child));
+							/* frame deixa de ser válido aqui. */
+							stack.push_back(Frame{child, child->start_key, 0, key->name});
+						}
+						else{
+							Named<Visitor> named = { visitor, key->name };
+
+							value(key, named);
+						}
+					}
+					else{
+						if(stack.size() > 1)
+							visitor(frame.name, End());
+
+						stack.pop_back();
+					}
+				}
+			}
+		};
+	};
+
+	namespace detail {
+		/* Tipo de chave e conversão de cada tipo aceito por Object::copyTo. */
+		template <typename T, typename Enable = void>
+		struct Element;
+
+		template <typename T>
+		struct Element<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type> {
+			static const int type = RJS_KEY_NUMBER;
+			static const bool packed = true;
+
+			static T convert(const rjs_key_t *key){
+				return (T) rjs_get_vnumber(key);
+			}
+		};
+
+		template <typename T>
+		struct Element<T, typename std::enable_if<std::is_same<T, bool>::value>::type> {
+			static const int type = RJS_KEY_BOOLEAN;
+			static const bool packed = false;
+
+			static bool convert(const rjs_key_t *key){
+				return key->value.data.r_bool != 0;
+			}
+		};
+
+		/* const char *, std::string e std::string_view. */
+		template <typename T>
+		struct Element<T, typename std::enable_if<std::is_constructible<T, const char *>::value && !std::is_arithmetic<T>::value>::type> {
+			static const int type = RJS_KEY_STRING;
+			static const bool packed = false;
+
+			static T convert(const rjs_key_t *key){
+				return T(key->value.data.str);
+			}
+		};
+
+		template <typename T>
+		struct Element<T, typename std::enable_if<std::is_same<T, Object>::value>::type> {
+			static const int type = RJS_KEY_OBJECT;
+			static const bool packed = false;
+
+			static Object convert(const rjs_key_t *key){
+				return Visit::object(key->value.data.obj);
+			}
+		};
+
+		/* Copia os números de uma array compactada; só tipos numéricos a
+		 * aceitam. */
+		template <typename T, typename Out>
+		rjs_size_t copy_packed(const rjs_object_t *array, Out out, rjs_size_t n, std::true_type){
+			rjs_size_t count = 0;
+
+			for(; count < n && count < array->length; count++)
+				*out++ = (T) array->numbers[count];
+
+			return count;
+		}
+
+		template <typename T, typename Out>
+		rjs_size_t copy_packed(const rjs_object_t *, Out, rjs_size_t, std::false_type){
+			return 0;
+		}
+
+		/* Copia até n elementos de array para out. Retorna quantos foram
+		 * copiados. */
+		template <typename T, typename Out>
+		rjs_size_t copy_elements(const rjs_object_t *array, Out out, rjs_size_t n){
+			typedef Element<T> Type;
+			rjs_size_t count = 0;
+
+			if(array->numbers != nullptr)
+				return copy_packed<T>(array, out, n, std::integral_constant<bool, Type::packed>());
+
+			for(const rjs_key_t *key = array->start_key; key != nullptr && count < n; key = key->next){
+				if(key->value.type != Type::type)
+					break;
+
+				*out++ = Type::convert(key);
+				count++;
+			}
+
+			return count;
+		}
+
+		/* Reserva espaço em containers que têm reserve. */
+		template <typename Container>
+		auto reserve(Container &container, rjs_size_t n, int) -> decltype(container.reserve(n), void()) {
+			container.reserve(n);
+		}
+
+		template <typename Container>
+		void reserve(Container &, rjs_size_t, long){
+		}
+	};
+
+	template <typename T>
+	rjs_size_t Object::copyTo(T *dst, rjs_size_t n){
+		if(!isValid())
+			return 0;
+
+		return detail::copy_elements<T>(object, dst, n);
+	}
+
+	template <typename Container>
+	Container Object::to(void){
+		Container result;
+
+		if(!isValid())
+			return result;
+
+		detail::reserve(result, size(), 0);
+		detail::copy_elements<typename Container::value_type>(object, std::back_inserter(result), size());
+
+		return result;
+	}
+
+	/* Chama visitor com o valor da chave já no seu tipo: const char * para
+	 * strings, double para números, bool, std::nullptr_t para null e
+	 * rjs::Object para objetos e arrays. O tipo é lido uma única vez, sem as
+	 * verificações de Key::get. Uma chave inválida é visitada como null.
+	 * Retorna o que visitor retornar; todas as versões devem retornar o
+	 * mesmo tipo. Exemplo, no C++17:
+	 * rjs::visit(key, rjs::overloaded{
+	 *	[](double number){ ... },
+	 *	[](rjs::Object object){ ... },
+	 *	[](auto other){ ... }
+	 * }); */
+	template <typename Visitor>
+	auto visit(Key key, Visitor &&visitor) -> decltype(visitor(nullptr)) {
+		return detail::Visit::value(key, visitor);
+	}
+
+	template <typename Visitor>
+	void Object::walk(Visitor &&visitor){
+		detail::Visit::walk(object, visitor);
+	}
+
+#if __cplusplus >= 201703L
+	/* Junta várias lambdas em um só visitor. */
+	template <typename... Visitors>
+	struct overloaded : Visitors... {
+		using Visitors::operator()...;
+	};
+
+	template <typename... Visitors>
+	overloaded(Visitors...) -> overloaded<Visitors...>;
+#endif
 
 	class Parser {
-		private:
+		protected:
 			rjs_parser_t parser;
+			/* Índice de caminhos de buildIndex. */
+			rjs_path_index_t index;
 
 		public:
 			/* Cria um parser com a memória e o tamanho dado. */
@@ -98,8 +511,87 @@ namespace rjs {
 			Object getMainObject(void);
 			/* Decodifica uma string. Retorna true caso haja sucesso. */
 			bool parse(const char *str);
+			/* Lê mais um documento sem descartar os anteriores (veja
+			 * rjs_parse_document). Retorna o seu objeto principal, inválido
+			 * caso a leitura falhe. */
+			Object parseDocument(const char *str);
+			/* Retorna o ponto atual da memória, para rollback. Durante uma
+			 * leitura em partes, a marca é recusada por rollback. */
+			rjs_mark_t mark(void);
+			/* Descarta tudo o que foi alocado depois da marca (veja
+			 * rjs_rollback). */
+			bool rollback(const rjs_mark_t &mark);
+			/* Prepara a leitura de uma string em partes (veja rjs_parse_begin).
+			 * A string deve continuar válida até o fim da leitura. */
+			bool begin(const char *str);
+			/* Continua a leitura começada por begin, lendo aproximadamente até
+			 * max_bytes bytes. Retorna RJS_PARSE_IN_PROGRESS, RJS_PARSE_DONE
+			 * ou RJS_PARSE_ERROR. */
+			int step(rjs_size_t max_bytes);
 			/* Retorna uma mensagem de erro. */
 			const char * getError();
+			/* Retorna o erro da última leitura, com a linha e a coluna. */
+			const rjs_error_t & getErrorInfo();
+			/* Define as flags do parser (veja RJS_FLAG_*). */
+			void setFlags(int flags);
+			/* Define onde as estatísticas das leituras serão escritas (veja
+			 * rjs_set_stats), ou nullptr para não coletá-las. */
+			void setStats(rjs_parse_stats_t *stats);
+			/* Filtra os elementos das arrays na profundidade depth durante a
+			 * leitura (veja rjs_set_filter). Retorna false caso os argumentos
+			 * sejam inválidos. */
+			bool setFilter(const rjs_predicate_t *predicates, int n, int depth);
+			/* Retorna quantos elementos o filtro descartou na última leitura. */
+			rjs_size_t getRejected(void);
+			/* Retorna quantos bytes buildIndex vai usar e, em keys, quantas
+			 * chaves serão indexadas (veja rjs_index_size). */
+			rjs_size_t indexSize(rjs_size_t *keys = nullptr);
+			/* Indexa os caminhos do documento lido, para que find os encontre
+			 * com uma busca (veja rjs_build_index). Retorna false caso falte
+			 * memória. */
+			bool buildIndex(void);
+			/* Retorna a chave no caminho dado, como "/statuses/0/id". Usa o
+			 * índice de buildIndex caso ele exista e o documento não tenha
+			 * mudado, e percorre o caminho caso contrário. */
+			Key find(const char *path);
+			/* Retorna true caso o índice de buildIndex exista e o documento não
+			 * tenha sido lido de novo ou editado depois dele (veja
+			 * rjs_index_valid). */
+			bool indexValid(void);
+			/* Retorna quantos bytes compact precisa. */
+			rjs_size_t compactSize(void);
+			/* Copia o documento para outro bloco, em uma ordem que favorece a
+			 * leitura (veja rjs_compact). Retorna o objeto principal da cópia,
+			 * inválido caso o bloco seja pequeno demais. */
+			Object compact(void *block, rjs_size_t size);
+			/* Converte um número lido com RJS_FLAG_LAZY_NUMBERS e o guarda na
+			 * chave, para que os próximos get não o convertam de novo (veja
+			 * rjs_cache_number). Retorna o número, ou 0 caso a chave não seja
+			 * um número. */
+			double cacheNumber(Key key);
+
+			/* Edição do documento (veja rjs_set_number e as seguintes).
+			 * As funções que retornam bool retornam false caso falte memória
+			 * ou os argumentos sejam inválidos. */
+
+			/* Cria um objeto vazio, ou uma array vazia. */
+			Object newObject(bool is_array = false);
+			/* Substituem o valor de uma chave. */
+			bool setNumber(Key key, double number);
+			bool setString(Key key, const char *str);
+			bool setBool(Key key, bool value);
+			bool setNull(Key key);
+			bool setObject(Key key, Object object);
+			/* Retorna a chave com o nome dado, criando-a caso não exista. */
+			Key insert(Object object, const char *name);
+			/* Cria um novo elemento no fim de uma array. */
+			Key append(Object array);
+			/* Cria uma chave no fim do objeto sem procurar uma com o mesmo
+			 * nome, que deve ser novo (veja rjs_append_key). */
+			Key append(Object object, const char *name);
+			/* Removem uma chave pelo nome ou um elemento pela posição. */
+			bool remove(Object object, const char *name);
+			bool remove(Object array, rjs_size_t index);
 	};
 
 };
@@ -0,0 +1,125 @@
+#include "r_json_pool.hpp"
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+#include <atomic>
+#include <thread>
+
+namespace rjs {
+
+	/* Pool */
+
+	Pool::Entry::Entry(rjs_size_t arena_size) : arena(arena_size), parser(arena.data(), arena_size) {
+	}
+
+	Pool::Pool(std::size_t parsers, rjs_size_t arena_size){
+		this->arena_size = arena_size;
+
+		for(std::size_t i = 0; i < parsers; i++){
+			entries.push_back(std::unique_ptr<Entry>(new Entry(arena_size)));
+			available.push_back(entries.back().get());
+		}
+	}
+
+	Parser * Pool::acquire(void){
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry *entry;
+
+		if(available.empty()){
+			entries.push_back(std::unique_ptr<Entry>(new Entry(arena_size)));
+			return &entries.back()->parser;
+		}
+
+		entry = available.back();
+		available.pop_back();
+
+		return &entry->parser;
+	}
+
+	void Pool::release(Parser *parser){
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for(std::size_t i = 0; i < entries.size(); i++){
+			if(&entries[i]->parser == parser){
+				available.push_back(entries[i].get());
+				return;
+			}
+		}
+	}
+
+	/* parse_batch */
+
+	namespace {
+		/* Parte dos documentos de uma thread. Cada uma fica em sua própria
+		 * linha de cache, para que as threads não disputem a mesma linha. */
+		struct alignas(64) Range {
+			std::atomic<std::size_t> next;
+			std::size_t end;
+		};
+
+		/* Pega o próximo documento da parte dada, ou retorna false caso ela
+		 * tenha acabado. */
+		bool take(Range &range, std::size_t *index){
+			if(range.next.load(std::memory_order_relaxed) >= range.end)
+				return false;
+
+			*index = range.next.fetch_add(1, std::memory_order_relaxed);
+
+			return *index < range.end;
+		}
+	};
+
+	void parse_batch(Pool &pool, const char * const *docs, std::size_t n, bool *results, unsigned threads, BatchCallback consume){
+		std::vector<Range> ranges(threads == 0 ? 1 : threads);
+		std::vector<std::thread> workers;
+
+		threads = (unsigned) ranges.size();
+
+		for(unsigned i = 0; i < threads; i++){
+			ranges[i].next.store(n * i / threads);
+			ranges[i].end = n * (i + 1) / threads;
+		}
+
+		auto work = [&](unsigned self){
+			Parser *parser = pool.acquire();
+			std::size_t index;
+
+			/* Primeiro a própria parte, depois as partes das outras threads. */
+			for(unsigned victim = 0; victim < threads; victim++){
+				Range &range = ranges[(self + victim) % threads];
+
+				while(take(range, &index)){
+					results[index] = parser->parse(docs[index]);
+
+					if(results[index] && consume)
+						consume(index, *parser);
+				}
+			}
+
+			pool.release(parser);
+		};
+
+		for(unsigned i = 1; i < threads; i++)
+			workers.push_back(std::thread(work, i));
+
+		work(0);
+
+		for(std::size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+};
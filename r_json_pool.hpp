@@ -0,0 +1,77 @@
+#ifndef R_JSON_POOL_HPP
+#define R_JSON_POOL_HPP
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Leitura de vários documentos em paralelo. Fica fora da r_json.h, pois
+ * depende de threads da standard library de C++. */
+
+#include "r_json_plus.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rjs {
+	/* Conjunto de parsers, cada um com a sua própria memória, que podem ser
+	 * emprestados por várias threads. A memória é alocada e tocada na
+	 * criação, e reaproveitada a cada empréstimo. */
+	class Pool {
+		private:
+			struct Entry {
+				std::vector<char> arena;
+				Parser parser;
+
+				Entry(rjs_size_t arena_size);
+			};
+
+			rjs_size_t arena_size;
+			std::vector<std::unique_ptr<Entry> > entries;
+			std::vector<Entry *> available;
+			std::mutex mutex;
+
+		public:
+			/* Cria o conjunto com parsers de arena_size bytes de memória. */
+			Pool(std::size_t parsers, rjs_size_t arena_size);
+
+			Pool(const Pool &) = delete;
+			Pool & operator=(const Pool &) = delete;
+
+			/* Empresta um parser. Caso não haja nenhum livre, cria um novo. */
+			Parser * acquire(void);
+			/* Devolve um parser emprestado por acquire. */
+			void release(Parser *parser);
+	};
+
+	/* Chamada para cada documento lido por parse_batch, na thread que o leu,
+	 * enquanto o documento ainda está na memória do parser. Recebe o índice do
+	 * documento e o parser. */
+	typedef std::function<void(std::size_t, Parser &)> BatchCallback;
+
+	/* Lê os n documentos de docs em paralelo, com threads threads, cada uma
+	 * com um parser emprestado do pool. Os documentos são divididos entre as
+	 * threads, e uma thread que termina a sua parte rouba documentos das
+	 * outras, sem locks. results[i] recebe true caso o documento i tenha sido
+	 * lido com sucesso. Caso consume não seja vazio, é chamada para cada
+	 * documento lido com sucesso. */
+	void parse_batch(Pool &pool, const char * const *docs, std::size_t n, bool *results, unsigned threads, BatchCallback consume = BatchCallback());
+};
+
+#endif
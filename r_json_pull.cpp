@@ -0,0 +1,91 @@
+#include "r_json_pull.hpp"
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+#if __cplusplus >= 201703L
+
+namespace rjs {
+
+	/* PullParser */
+
+	PullParser::PullParser(std::string_view text, char *buffer, rjs_size_t size){
+		rjs_reader_create(&reader, buffer, size);
+		rjs_reader_feed(&reader, text.data(), text.size());
+		status = RJS_READER_EVENT;
+	}
+
+	PullParser::PullParser(Source source, char *buffer, rjs_size_t size) : source(std::move(source)) {
+		rjs_reader_create(&reader, buffer, size);
+		status = RJS_READER_EVENT;
+	}
+
+	bool PullParser::next(Event &event){
+		rjs_event_t raw;
+
+		for(;;){
+			status = rjs_reader_next(&reader, &raw);
+
+			if(status != RJS_READER_NEED_INPUT)
+				break;
+
+			/* Sem uma função, o texto dado no construtor era o único pedaço. */
+			std::string_view chunk = source ? source() : std::string_view();
+
+			rjs_reader_feed(&reader, chunk.data(), chunk.size());
+		}
+
+		if(status != RJS_READER_EVENT)
+			return false;
+
+		event.type = raw.type;
+		event.depth = raw.depth;
+
+		if(raw.type == RJS_EVENT_KEY || raw.type == RJS_EVENT_STRING || raw.type == RJS_EVENT_NUMBER)
+			event.text = std::string_view(raw.str, raw.length);
+		else
+			event.text = std::string_view();
+
+		event.number = raw.type == RJS_EVENT_NUMBER ? raw.number : 0.0;
+		event.boolean = raw.type == RJS_EVENT_BOOLEAN && raw.r_bool;
+
+		return true;
+	}
+
+	bool PullParser::skip(void){
+		return rjs_reader_skip(&reader);
+	}
+
+	bool PullParser::failed(void) const {
+		return status == RJS_READER_ERROR;
+	}
+
+	const char * PullParser::getError(void){
+		return rjs_reader_get_error(&reader);
+	}
+
+#ifdef RJS_PULL_COROUTINE
+	detail::Generator<Event> PullParser::events(void){
+		Event event;
+
+		while(next(event))
+			co_yield event;
+	}
+#endif
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef R_JSON_PULL_HPP
+#define R_JSON_PULL_HPP
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Leitura por eventos em C++ (C++17, e C++20 para a coroutine), sobre o
+ * leitor de eventos da r_json.h. Exemplo, que para de ler ao achar a chave:
+ *
+ *	char buffer[4096];
+ *	rjs::PullParser parser(text, buffer, sizeof(buffer));
+ *
+ *	for(const rjs::Event &event : parser.events()){
+ *		if(event.isKey("id")){
+ *			...
+ *			break;
+ *		}
+ *		else if(event.isKey("entities")){
+ *			parser.skip();
+ *		}
+ *	}
+ *
+ * Nenhuma memória é alocada, exceto o quadro da coroutine de events. */
+
+#include "r_json.h"
+
+#if __cplusplus >= 201703L
+
+#include <functional>
+#include <string_view>
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <cstddef>
+#include <iterator>
+#define RJS_PULL_COROUTINE
+#endif
+
+namespace rjs {
+	/* Evento lido pelo PullParser (veja rjs_event_t). O texto pertence ao
+	 * pedaço lido ou ao buffer do parser, e só é válido até o próximo
+	 * evento. */
+	struct Event {
+		/* O tipo, segundo a enumeração rjs_event_type. */
+		int type;
+		/* Nome da chave, valor da string ou texto do número. */
+		std::string_view text;
+		double number;
+		bool boolean;
+		int depth;
+
+		/* Retorna true caso o evento seja a chave com o nome dado. */
+		bool isKey(std::string_view name) const {
+			return type == RJS_EVENT_KEY && text == name;
+		}
+	};
+
+#ifdef RJS_PULL_COROUTINE
+	namespace detail {
+		/* Gerador mínimo para a coroutine de eventos, já que o
+		 * std::generator só existe a partir do C++23. */
+		template <typename T>
+		class Generator {
+			public:
+				struct promise_type {
+					const T *current;
+
+					Generator get_return_object(void){
+						return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+					}
+
+					std::suspend_always initial_suspend(void) noexcept { return {}; }
+					std::suspend_always final_suspend(void) noexcept { return {}; }
+
+					std::suspend_always yield_value(const T &value) noexcept {
+						current = &value;
+						return {};
+					}
+
+					void return_void(void) noexcept {}
+					void unhandled_exception(void){ throw; }
+				};
+
+				class iterator {
+					private:
+						std::coroutine_handle<promise_type> handle;
+
+					public:
+						typedef std::ptrdiff_t difference_type;
+						typedef T value_type;
+
+						iterator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+						const T & operator*(void) const {
+							return *handle.promise().current;
+						}
+
+						iterator & operator++(void){
+							handle.resume();
+							return *this;
+						}
+
+						void operator++(int){
+							handle.resume();
+						}
+
+						bool operator==(std::default_sentinel_t) const {
+							return handle.done();
+						}
+				};
+
+				Generator(Generator &&other) noexcept : handle(other.handle) {
+					other.handle = nullptr;
+				}
+
+				Generator(const Generator &) = delete;
+				Generator & operator=(const Generator &) = delete;
+
+				~Generator(void){
+					if(handle)
+						handle.destroy();
+				}
+
+				/* Avança até o primeiro evento. */
+				iterator begin(void){
+					handle.resume();
+					return iterator(handle);
+				}
+
+				std::default_sentinel_t end(void){
+					return std::default_sentinel;
+				}
+
+			private:
+				std::coroutine_handle<promise_type> handle;
+
+				Generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+		};
+	};
+#endif
+
+	/* Leitor de eventos que pede os eventos um a um. O texto pode ser dado
+	 * inteiro ou em pedaços, por uma função. */
+	class PullParser {
+		public:
+			/* Retorna o próximo pedaço do texto, ou um pedaço vazio no fim.
+			 * Cada pedaço deve continuar válido até o próximo ser pedido. */
+			typedef std::function<std::string_view(void)> Source;
+
+		private:
+			rjs_reader_t reader;
+			Source source;
+			int status;
+
+		public:
+			/* Lê o texto inteiro dado. buffer é usado para strings com
+			 * caracteres de controle (veja rjs_reader_create). */
+			PullParser(std::string_view text, char *buffer, rjs_size_t size);
+			/* Lê o texto em pedaços, pedidos a source quando preciso. */
+			PullParser(Source source, char *buffer, rjs_size_t size);
+
+			/* Lê o próximo evento. Retorna false no fim do documento ou caso
+			 * haja um erro (veja failed). */
+			bool next(Event &event);
+			/* Pula o conteúdo do último evento: o resto de um objeto ou array
+			 * aberto, ou o valor de uma chave (veja rjs_reader_skip).
+			 * Retorna false caso não haja o que pular. */
+			bool skip(void);
+			/* Retorna true caso a leitura tenha parado por um erro. */
+			bool failed(void) const;
+			/* Retorna a mensagem de erro. */
+			const char * getError(void);
+
+#ifdef RJS_PULL_COROUTINE
+			/* Retorna os eventos como uma coroutine, para ser percorrida com
+			 * um for. Sair do for para a leitura. */
+			detail::Generator<Event> events(void);
+#endif
+	};
+};
+
+#endif
+
+#endif
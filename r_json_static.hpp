@@ -0,0 +1,484 @@
+#ifndef R_JSON_STATIC_HPP
+#define R_JSON_STATIC_HPP
+
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Leitura de documentos em tempo de compilação (C++20). Um literal de string
+ * vira um documento estático, com as mesmas estruturas que o parser cria na
+ * memória, que pode ser lido pelo rjs::Object e rjs::Key sem nenhuma leitura
+ * ou memória em tempo de execução. Exemplo:
+ *
+ *	using namespace rjs::literals;
+ *	rjs::Object config = R"({"threads": 4, "name": "r_json"})"_rjs;
+ *
+ * Um literal inválido é um erro de compilação. O documento fica em memória
+ * somente de leitura, então as funções de edição não podem ser usadas nele. */
+
+#include "r_json_plus.hpp"
+
+#if __cplusplus >= 202002L
+
+#include <cstddef>
+#include <limits>
+
+namespace rjs {
+	namespace detail {
+		/* Literal de string que pode ser usado como parâmetro de template. */
+		template <std::size_t N>
+		struct FixedString {
+			char data[N];
+
+			constexpr FixedString(const char (&str)[N]){
+				for(std::size_t i = 0; i < N; i++)
+					data[i] = str[i];
+			}
+		};
+
+		/* Quantidade de cada estrutura que o documento precisa. */
+		struct StaticCount {
+			std::size_t objects;
+			std::size_t keys;
+			std::size_t chars;
+		};
+
+		/* Lê o documento com as regras do rjs_parse_string. Caso não haja
+		 * onde escrever (objects é nullptr), apenas conta as estruturas. */
+		class StaticParser {
+			private:
+				const char *str;
+				std::size_t index;
+				rjs_object_t *objects;
+				rjs_key_t *keys;
+				char *chars;
+				StaticCount count;
+
+				/* Uma exceção não pode ser lançada em tempo de compilação, então
+				 * um literal inválido faz a compilação falhar nesse ponto, com
+				 * a mensagem no diagnóstico. */
+				constexpr void error(const char *message){
+					if(message != nullptr)
+						throw message;
+				}
+
+				constexpr bool is_space(char c){
+					return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+				}
+
+				constexpr void skip_space(void){
+					while(is_space(str[index]))
+						index++;
+				}
+
+				constexpr void put(char c){
+					if(chars != nullptr)
+						chars[count.chars] = c;
+
+					count.chars++;
+				}
+
+				constexpr int hex_digit(char c){
+					if(c >= '0' && c <= '9') return c - '0';
+					if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+					if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+					return -1;
+				}
+
+				constexpr unsigned long read_unicode(void){
+					unsigned long unicode = 0;
+
+					for(int i = 0; i < 4; i++){
+						int digit = hex_digit(str[index++]);
+
+						if(digit == -1)
+							error("Expected hexadecimal digit.");
+
+						unicode = unicode * 16 + (unsigned long) digit;
+					}
+
+					return unicode;
+				}
+
+				constexpr void put_codepoint(unsigned long codepoint){
+					if(codepoint < 0x80){
+						put((char) codepoint);
+					}
+					else if(codepoint < 0x800){
+						put((char) (0xC0 | (codepoint >> 6)));
+						put((char) (0x80 | (codepoint & 0x3F)));
+					}
+					else if(codepoint < 0x10000){
+						put((char) (0xE0 | (codepoint >> 12)));
+						put((char) (0x80 | ((codepoint >> 6) & 0x3F)));
+						put((char) (0x80 | (codepoint & 0x3F)));
+					}
+					else{
+						put((char) (0xF0 | (codepoint >> 18)));
+						put((char) (0x80 | ((codepoint >> 12) & 0x3F)));
+						put((char) (0x80 | ((codepoint >> 6) & 0x3F)));
+						put((char) (0x80 | (codepoint & 0x3F)));
+					}
+				}
+
+				/* Lê a string que começa no caractere atual (as aspas) e
+				 * retorna onde ela foi escrita. */
+				constexpr const char * parse_string(void){
+					const char *location = chars != nullptr ? chars + count.chars : nullptr;
+
+					index++;
+
+					while(str[index] != '\"'){
+						char current = str[index++];
+
+						if(current == '\0'){
+							error("Expected quote.");
+						}
+						else if(current != '\\'){
+							put(current);
+						}
+						else{
+							char control = str[index++];
+
+							if(control == '\"' || control == '\\' || control == '/') put(control);
+							else if(control == 'b') put('\b');
+							else if(control == 'f') put('\f');
+							else if(control == 'n') put('\n');
+							else if(control == 'r') put('\r');
+							else if(control == 't') put('\t');
+							else if(control == 'u'){
+								unsigned long unicode = read_unicode();
+
+								if(unicode >= 0xD800 && unicode <= 0xDBFF){
+									unsigned long low;
+
+									if(str[index] != '\\' || str[index + 1] != 'u')
+										error("Expected low surrogate.");
+
+									index += 2;
+									low = read_unicode();
+
+									if(low < 0xDC00 || low > 0xDFFF)
+										error("Expected low surrogate.");
+
+									unicode = 0x10000 + ((unicode - 0xD800) << 10) + (low - 0xDC00);
+								}
+								else if(unicode >= 0xDC00 && unicode <= 0xDFFF){
+									error("Unexpected low surrogate.");
+								}
+								else if(unicode == 0){
+									error("Null character in string.");
+								}
+
+								put_codepoint(unicode);
+							}
+							else{
+								error("Expected control character.");
+							}
+						}
+					}
+
+					index++;
+					put('\0');
+
+					return location;
+				}
+
+				/* Mesmas potências do rjs_pow10. Acima de 10^308, o resultado
+				 * é infinito, como em tempo de execução; o estouro de uma
+				 * multiplicação não seria uma expressão constante. */
+				constexpr double pow10(int exponent){
+					constexpr double powers[9] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+					double result = 1.0;
+
+					if(exponent > 308)
+						return std::numeric_limits<double>::infinity();
+
+					for(int i = 0; exponent != 0; i++){
+						if(exponent % 2 == 1)
+							result = result * powers[i];
+
+						exponent /= 2;
+					}
+
+					return result;
+				}
+
+				/* Mesma conversão do rjs_strtod, para que os números sejam
+				 * idênticos aos lidos em tempo de execução. */
+				constexpr double parse_number(void){
+					double number = 0, fraction = 0, counter_fraction = 1;
+					int is_negative = 1, exponent = 0, is_negative_exponent = 1;
+					int state = 0;
+					bool has_exponent = false;
+					std::size_t start = index;
+
+					if(str[index] == '-'){
+						is_negative = -1;
+						index++;
+					}
+
+					if(str[index] == '0' && str[index + 1] >= '0' && str[index + 1] <= '9')
+						error("Error while parsing number.");
+
+					for(; !is_space(str[index]) && str[index] != ',' && str[index] != '}'
+							&& str[index] != ']' && str[index] != '\0'; index++){
+						char current = str[index];
+						bool digit = current >= '0' && current <= '9';
+
+						if(state == 0 && digit){
+							number = (current - '0') + number * 10;
+						}
+						else if(state == 0 && current == '.'){
+							state = 1;
+						}
+						else if(state == 1 && digit){
+							fraction = (current - '0') + fraction * 10;
+							counter_fraction /= 10;
+						}
+						else if(state != 2 && (current == 'e' || current == 'E')){
+							state = 2;
+							has_exponent = true;
+						}
+						else if(state == 2 && digit){
+							/* Como no rjs_strtod, o expoente para de crescer
+							 * antes de passar do maior int. */
+							if(exponent < 100000)
+								exponent = (current - '0') + exponent * 10;
+						}
+						else if(state == 2 && (current == '-' || current == '+')){
+							if(current == '-')
+								is_negative_exponent = -1;
+						}
+						else{
+							error("Error while parsing number.");
+						}
+					}
+
+					if(index == start || (is_negative == -1 && index == start + 1))
+						error("Error while parsing number.");
+
+					number = (number + counter_fraction * fraction) * is_negative;
+
+					if(has_exponent && number != 0){
+						if(is_negative_exponent == -1){
+							while(exponent > 308){
+								number = number / 1e308;
+								exponent -= 308;
+							}
+
+							number = number / pow10(exponent);
+						}
+						else{
+							constexpr double max = std::numeric_limits<double>::max();
+							double scale = pow10(exponent);
+							double magnitude = number < 0 ? -number : number;
+
+							if(scale > max || magnitude > max / scale)
+								number = number * std::numeric_limits<double>::infinity();
+							else
+								number = number * scale;
+						}
+					}
+
+					return number;
+				}
+
+				constexpr bool literal(const char *word){
+					std::size_t i = 0;
+
+					for(; word[i] != '\0'; i++){
+						if(str[index + i] != word[i])
+							return false;
+					}
+
+					index += i;
+
+					return true;
+				}
+
+				constexpr void parse_value(rjs_key_t *key, std::size_t parent){
+					char current = str[index];
+					rjs_value_t value{};
+
+					if(current == '\"'){
+						value.type = RJS_KEY_STRING;
+						value.data.str = parse_string();
+					}
+					else if(current == '{' || current == '['){
+						value.type = RJS_KEY_OBJECT;
+						value.data.obj = parse_object(current == '[', parent);
+					}
+					else if(current == '-' || (current >= '0' && current <= '9')){
+						value.type = RJS_KEY_NUMBER;
+						value.data.number = parse_number();
+					}
+					else if(literal("true") || literal("false")){
+						value.type = RJS_KEY_BOOLEAN;
+						value.data.r_bool = current == 't';
+					}
+					else if(literal("null")){
+						value.type = RJS_KEY_NULL;
+					}
+					else{
+						error("Expected value: number, array, object, boolean or null.");
+					}
+
+					if(key != nullptr)
+						key->value = value;
+				}
+
+				/* Lê o objeto ou array que começa no caractere atual. As
+				 * posições são relativas ao pai, como no parser. */
+				constexpr rjs_object_t * parse_object(bool is_array, std::size_t parent){
+					rjs_object_t *object = objects != nullptr ? objects + count.objects : nullptr;
+					char close = is_array ? ']' : '}';
+					std::size_t start = index;
+
+					count.objects++;
+
+					if(object != nullptr){
+						object->is_array = is_array;
+						object->offset = start - parent;
+					}
+
+					index++;
+					skip_space();
+
+					while(str[index] != close){
+						rjs_key_t *key = keys != nullptr ? keys + count.keys : nullptr;
+						const char *name = nullptr;
+
+						count.keys++;
+
+						if(!is_array){
+							if(str[index] != '\"')
+								error("Expected quote.");
+
+							name = parse_string();
+							skip_space();
+
+							if(str[index] != ':')
+								error("Expected colon.");
+
+							index++;
+							skip_space();
+						}
+
+						parse_value(key, start);
+						skip_space();
+
+						if(object != nullptr){
+							key->name = name;
+
+							if(object->start_key == nullptr)
+								object->start_key = key;
+							else
+								object->end_key->next = key;
+
+							object->end_key = key;
+							object->length++;
+						}
+
+						if(str[index] == ','){
+							index++;
+							skip_space();
+						}
+						else if(str[index] != close){
+							error(is_array ? "Expected square bracket." : "Expected close bracket or comma character.");
+						}
+					}
+
+					index++;
+
+					if(object != nullptr)
+						object->size = index - start;
+
+					return object;
+				}
+
+			public:
+				constexpr StaticParser(const char *str, rjs_object_t *objects, rjs_key_t *keys, char *chars)
+					: str(str), index(0), objects(objects), keys(keys), chars(chars), count{0, 0, 0} {}
+
+				constexpr StaticCount parse(void){
+					skip_space();
+
+					if(str[index] != '{')
+						error("Expected open bracket.");
+
+					parse_object(false, 0);
+					skip_space();
+
+					if(str[index] != '\0')
+						error("Unexpected character after the document.");
+
+					return count;
+				}
+		};
+
+		/* O documento: as mesmas estruturas criadas pelo parser, ligadas por
+		 * ponteiros para dentro de si mesmo. O objeto principal é o primeiro. */
+		template <std::size_t Objects, std::size_t Keys, std::size_t Chars>
+		struct StaticDocument {
+			rjs_object_t objects[Objects];
+			rjs_key_t keys[Keys > 0 ? Keys : 1];
+			char chars[Chars > 0 ? Chars : 1];
+
+			constexpr StaticDocument(const char *str) : objects{}, keys{}, chars{} {
+				StaticParser(str, objects, keys, chars).parse();
+			}
+		};
+
+		template <FixedString S>
+		inline constexpr StaticCount static_count = StaticParser(S.data, nullptr, nullptr, nullptr).parse();
+
+		template <FixedString S>
+		inline constexpr StaticDocument<static_count<S>.objects, static_count<S>.keys, static_count<S>.chars>
+			static_document(S.data);
+
+		struct StaticAccess {
+			static Object object(const rjs_object_t *object){
+				return Object(object);
+			}
+		};
+	};
+
+	/* Retorna o objeto principal do documento lido em tempo de compilação. */
+	template <detail::FixedString S>
+	Object static_object(void){
+		return detail::StaticAccess::object(&detail::static_document<S>.objects[0]);
+	}
+
+	/* Retorna o ponteiro para o objeto principal, para a API de C. */
+	template <detail::FixedString S>
+	constexpr const rjs_object_t * static_root(void){
+		return &detail::static_document<S>.objects[0];
+	}
+
+	namespace literals {
+		/* "{...}"_rjs é o mesmo que static_object<"{...}">(). */
+		template <detail::FixedString S>
+		Object operator""_rjs(void){
+			return static_object<S>();
+		}
+	};
+};
+
+#endif
+
+#endif
@@ -0,0 +1,541 @@
+/*
+ *	  This file is part of r_json.
+ *	  r_json is free software: you can redistribute it and/or modify it
+ *	  under the terms of the GNU General Public License as published by the
+ *	  Free Software Foundation, either version 3 of the License, or (at
+ *	  your option) any later version.
+ *
+ *	  r_json is distributed in the hope that it will be useful,
+ *	  but WITHOUT ANY WARRANTY; without even the implied warranty
+ *	  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	  See the GNU General Public License for more details.
+ *
+ *	  You should have received a copy of the GNU General Public License
+ *	  along with r_json. If not, see <https://www.gnu.org/licenses/>.
+ *	  Copyright	Gabriel Martins (C) 2025
+*/
+
+/* Gerador de parsers especializados. Lê um documento de exemplo e gera
+ * <nome>.h, com uma struct em C89 para o formato do exemplo, e <nome>.c, com
+ * um parser que espera as chaves na mesma ordem e com os mesmos tipos. Caso
+ * um documento não tenha esse formato, o parser gerado usa o rjs_parse_string
+ * e preenche a struct a partir do documento lido.
+ *
+ * Uso: rjs_gen <exemplo.json> <nome>
+ *
+ * Números viram double, strings const char *, booleanos int e objetos
+ * structs. Arrays são guardadas como o seu texto (<nome>_raw_t), que pode ser
+ * lido depois com o rjs_parse_string. Chaves com null no exemplo só são
+ * aceitas com null, e não aparecem na struct. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r_json.h"
+
+#define GEN_NAME_SIZE 256
+
+/* Nome usado como prefixo de tudo que é gerado. */
+static char prefix[GEN_NAME_SIZE];
+
+/* Converte str em um identificador de C, escrito em out. O tamanho é limitado
+ * para que caiba um sufixo numérico. */
+static void gen_identifier(char *out, const char *str){
+	rjs_size_t i;
+
+	for(i = 0; str[i] != '\0' && i < GEN_NAME_SIZE - 32; i++){
+		char c = str[i];
+
+		if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+			out[i] = c;
+		else
+			out[i] = '_';
+	}
+
+	out[i] = '\0';
+
+	if(i == 0 || (out[0] >= '0' && out[0] <= '9')){
+		memmove(out + 1, out, i + 1);
+		out[0] = '_';
+	}
+}
+
+/* Retorna os nomes dos campos das chaves do objeto, na ordem das chaves,
+ * cada um com GEN_NAME_SIZE bytes. Nomes que se repetiriam recebem os sufixos
+ * _0, _1... até que sejam diferentes de todos os anteriores, inclusive de
+ * chaves cujo nome já termina assim. Deve ser liberado com free. */
+static char *gen_fields(const rjs_object_t *obj){
+	const rjs_key_t *key;
+	rjs_size_t i = 0, j;
+	char *fields = malloc((obj->length != 0 ? obj->length : 1) * GEN_NAME_SIZE);
+
+	if(fields == NULL){
+		fprintf(stderr, "rjs_gen: memória insuficiente\n");
+		exit(1);
+	}
+
+	for(key = obj->start_key; key != NULL; key = key->next, i++){
+		char *field = fields + i * GEN_NAME_SIZE;
+		rjs_size_t length, suffix = 0;
+
+		gen_identifier(field, key->name);
+		length = strlen(field);
+
+		for(j = 0; j < i; j++){
+			if(strcmp(fields + j * GEN_NAME_SIZE, field) == 0){
+				sprintf(field + length, "_%lu", (unsigned long) suffix++);
+				j = (rjs_size_t) -1;
+			}
+		}
+	}
+
+	return fields;
+}
+
+/* Escreve o nome da struct de um objeto filho. */
+static void gen_child_type(char *out, const char *type, const char *field){
+	sprintf(out, "%.*s_%.*s", GEN_NAME_SIZE / 2 - 2, type, GEN_NAME_SIZE / 2 - 2, field);
+}
+
+static int gen_is_object(const rjs_key_t *key){
+	return rjs_istype(key, RJS_KEY_OBJECT) && !rjs_get_vobj(key)->is_array;
+}
+
+static int gen_is_array(const rjs_key_t *key){
+	return rjs_istype(key, RJS_KEY_OBJECT) && rjs_get_vobj(key)->is_array;
+}
+
+/* Retorna 1 caso o documento tenha algum valor do tipo dado. Arrays são
+ * indicadas com o tipo -1. */
+static int gen_has_type(const rjs_object_t *obj, int type){
+	const rjs_key_t *key;
+
+	for(key = obj->start_key; key != NULL; key = key->next){
+		if(type == -1 ? gen_is_array(key) : (!gen_is_object(key) && rjs_istype(key, type)))
+			return 1;
+
+		if(gen_is_object(key) && gen_has_type(rjs_get_vobj(key), type))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Escreve uma string de C com o texto da chave em json, com as aspas. */
+static void gen_key_literal(FILE *out, const char *name, rjs_size_t *length){
+	rjs_size_t i;
+
+	fputs("\"\\\"", out);
+	*length = 2;
+
+	for(i = 0; name[i] != '\0'; i++){
+		unsigned char c = (unsigned char) name[i];
+
+		if(c == '\"' || c == '\\'){
+			/* No json, a barra é escrita antes do caractere. */
+			fprintf(out, "\\\\\\%c", c);
+			*length += 2;
+		}
+		else if(c < 0x20 || c >= 0x7F){
+			fprintf(out, "\\%03o", c);
+			(*length)++;
+		}
+		else{
+			fputc(c, out);
+			(*length)++;
+		}
+	}
+
+	fputs("\\\"\"", out);
+}
+
+/* Escreve uma string de C com o nome da chave. */
+static void gen_name_literal(FILE *out, const char *name){
+	rjs_size_t i;
+
+	fputc('\"', out);
+
+	for(i = 0; name[i] != '\0'; i++){
+		unsigned char c = (unsigned char) name[i];
+
+		if(c == '\"' || c == '\\')
+			fprintf(out, "\\%c", c);
+		else if(c < 0x20 || c >= 0x7F)
+			fprintf(out, "\\%03o", c);
+		else
+			fputc(c, out);
+	}
+
+	fputc('\"', out);
+}
+
+/* Gera as structs, dos filhos para os pais. */
+static void gen_struct(FILE *out, const rjs_object_t *obj, const char *type){
+	const rjs_key_t *key;
+	char *fields = gen_fields(obj);
+	char *field;
+	char child[GEN_NAME_SIZE];
+
+	for(key = obj->start_key, field = fields; key != NULL; key = key->next, field += GEN_NAME_SIZE){
+		if(gen_is_object(key)){
+			gen_child_type(child, type, field);
+			gen_struct(out, rjs_get_vobj(key), child);
+		}
+	}
+
+	fprintf(out, "typedef struct {\n");
+
+	for(key = obj->start_key, field = fields; key != NULL; key = key->next, field += GEN_NAME_SIZE){
+		if(rjs_istype(key, RJS_KEY_NUMBER))
+			fprintf(out, "\tdouble %s;\n", field);
+		else if(rjs_istype(key, RJS_KEY_STRING))
+			fprintf(out, "\tconst char *%s;\n", field);
+		else if(rjs_istype(key, RJS_KEY_BOOLEAN))
+			fprintf(out, "\tint %s;\n", field);
+		else if(gen_is_array(key))
+			fprintf(out, "\t%s_raw_t %s;\n", prefix, field);
+		else if(gen_is_object(key)){
+			gen_child_type(child, type, field);
+			fprintf(out, "\t%s_t %s;\n", child, field);
+		}
+	}
+
+	/* Uma struct de C precisa de ao menos um campo. */
+	if(obj->start_key == NULL)
+		fprintf(out, "\tint empty;\n");
+
+	fprintf(out, "} %s_t;\n\n", type);
+
+	free(fields);
+}
+
+/* Gera o caminho rápido e o caminho genérico de cada objeto. */
+static void gen_functions(FILE *out, const rjs_object_t *obj, const char *type){
+	const rjs_key_t *key;
+	char *fields = gen_fields(obj);
+	char *field;
+	char child[GEN_NAME_SIZE];
+	int first = 1;
+
+	for(key = obj->start_key, field = fields; key != NULL; key = key->next, field += GEN_NAME_SIZE){
+		if(gen_is_object(key)){
+			gen_child_type(child, type, field);
+			gen_functions(out, rjs_get_vobj(key), child);
+		}
+	}
+
+	fprintf(out, "static const char *%s_fast(const char *p, %s_t *out, char **cursor, char *end){\n", type, type);
+	fprintf(out, "\t(void) out;\n\t(void) cursor;\n\t(void) end;\n\n");
+	fprintf(out, "\tp = %s_skip(p);\n\n\tif(*p != '{')\n\t\treturn NULL;\n\n\tp = %s_skip(p + 1);\n\n", prefix, prefix);
+
+	for(key = obj->start_key, field = fields; key != NULL; key = key->next, field += GEN_NAME_SIZE){
+		rjs_size_t length;
+
+		if(!first)
+			fprintf(out, "\tif(*p != ',')\n\t\treturn NULL;\n\n\tp = %s_skip(p + 1);\n\n", prefix);
+
+		first = 0;
+
+		fprintf(out, "\tif(!%s_match(p, ", prefix);
+		gen_key_literal(out, key->name, &length);
+		fprintf(out, ", %lu))\n\t\treturn NULL;\n\n", (unsigned long) length);
+		fprintf(out, "\tp = %s_skip(p + %lu);\n\n\tif(*p != ':')\n\t\treturn NULL;\n\n\tp = %s_skip(p + 1);\n",
+				prefix, (unsigned long) length, prefix);
+
+		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			fprintf(out, "\tp = %s_number(p, &out->%s);\n", prefix, field);
+		}
+		else if(rjs_istype(key, RJS_KEY_STRING)){
+			fprintf(out, "\tp = %s_string(p, &out->%s, cursor, end);\n", prefix, field);
+		}
+		else if(rjs_istype(key, RJS_KEY_BOOLEAN)){
+			fprintf(out, "\tp = %s_bool(p, &out->%s);\n", prefix, field);
+		}
+		else if(rjs_istype(key, RJS_KEY_NULL)){
+			fprintf(out, "\tp = %s_match(p, \"null\", 4) ? p + 4 : NULL;\n", prefix);
+		}
+		else if(gen_is_array(key)){
+			fprintf(out, "\tout->%s.raw = p;\n\tp = %s_skip_array(p);\n", field, prefix);
+			fprintf(out, "\tout->%s.length = p != NULL ? (rjs_size_t) (p - out->%s.raw) : 0;\n", field, field);
+		}
+		else{
+			gen_child_type(child, type, field);
+			fprintf(out, "\tp = %s_fast(p, &out->%s, cursor, end);\n", child, field);
+		}
+
+		fprintf(out, "\n\tif(p == NULL)\n\t\treturn NULL;\n\n\tp = %s_skip(p);\n\n", prefix);
+	}
+
+	fprintf(out, "\tif(*p != '}')\n\t\treturn NULL;\n\n\treturn p + 1;\n}\n\n");
+
+	fprintf(out, "static void %s_generic(const rjs_object_t *obj, %s_t *out, const char *str, rjs_size_t base){\n", type, type);
+	fprintf(out, "\tconst rjs_key_t *key;\n\n\t(void) key;\n\t(void) str;\n\t(void) base;\n");
+
+	if(obj->start_key == NULL)
+		fprintf(out, "\t(void) obj;\n\tout->empty = 0;\n");
+
+	for(key = obj->start_key, field = fields; key != NULL; key = key->next, field += GEN_NAME_SIZE){
+		if(rjs_istype(key, RJS_KEY_NULL))
+			continue;
+
+		fprintf(out, "\n\tkey = obj != NULL ? rjs_get_key(obj, ");
+		gen_name_literal(out, key->name);
+		fprintf(out, ") : NULL;\n");
+
+		if(rjs_istype(key, RJS_KEY_NUMBER)){
+			fprintf(out, "\tout->%s = rjs_istype(key, RJS_KEY_NUMBER) ? rjs_get_vnumber(key) : 0;\n", field);
+		}
+		else if(rjs_istype(key, RJS_KEY_STRING)){
+			fprintf(out, "\tout->%s = rjs_istype(key, RJS_KEY_STRING) ? rjs_get_vstring(key) : NULL;\n", field);
+		}
+		else if(rjs_istype(key, RJS_KEY_BOOLEAN)){
+			fprintf(out, "\tout->%s = rjs_istype(key, RJS_KEY_BOOLEAN) ? rjs_get_vbool(key) : 0;\n", field);
+		}
+		else if(gen_is_array(key)){
+			fprintf(out, "\tout->%s.raw = NULL;\n\tout->%s.length = 0;\n\n", field, field);
+			fprintf(out, "\tif(rjs_istype(key, RJS_KEY_OBJECT) && rjs_get_vobj(key)->is_array && rjs_get_vobj(key)->size != 0){\n");
+			fprintf(out, "\t\tout->%s.raw = str + base + rjs_get_vobj(key)->offset;\n", field);
+			fprintf(out, "\t\tout->%s.length = rjs_get_vobj(key)->size;\n\t}\n", field);
+		}
+		else{
+			gen_child_type(child, type, field);
+			fprintf(out, "\tif(rjs_istype(key, RJS_KEY_OBJECT) && !rjs_get_vobj(key)->is_array)\n");
+			fprintf(out, "\t\t%s_generic(rjs_get_vobj(key), &out->%s, str, base + rjs_get_vobj(key)->offset);\n", child, field);
+			fprintf(out, "\telse\n\t\t%s_generic(NULL, &out->%s, str, base);\n", child, field);
+		}
+	}
+
+	fprintf(out, "}\n\n");
+
+	free(fields);
+}
+
+/* Gera as funções auxiliares usadas pelos campos do documento. */
+static void gen_helpers(FILE *out, const rjs_object_t *root){
+	fprintf(out,
+		"static const char *%s_skip(const char *p){\n"
+		"\twhile(*p == ' ' || *p == '\\n' || *p == '\\t' || *p == '\\r')\n"
+		"\t\tp++;\n\n"
+		"\treturn p;\n"
+		"}\n\n", prefix);
+
+	fprintf(out,
+		"static int %s_match(const char *p, const char *literal, rjs_size_t length){\n"
+		"\trjs_size_t i;\n\n"
+		"\tfor(i = 0; i < length; i++){\n"
+		"\t\tif(p[i] != literal[i])\n"
+		"\t\t\treturn 0;\n"
+		"\t}\n\n"
+		"\treturn 1;\n"
+		"}\n\n", prefix);
+
+	if(gen_has_type(root, RJS_KEY_NUMBER)){
+		fprintf(out,
+			"static const char *%s_number(const char *p, double *number){\n"
+			"\trjs_size_t length = rjs_read_number(p, number);\n\n"
+			"\treturn length != 0 ? p + length : NULL;\n"
+			"}\n\n", prefix);
+	}
+
+	if(gen_has_type(root, RJS_KEY_BOOLEAN)){
+		fprintf(out,
+			"static const char *%s_bool(const char *p, int *value){\n"
+			"\tif(%s_match(p, \"true\", 4)){\n"
+			"\t\t*value = 1;\n"
+			"\t\treturn p + 4;\n"
+			"\t}\n\n"
+			"\tif(%s_match(p, \"false\", 5)){\n"
+			"\t\t*value = 0;\n"
+			"\t\treturn p + 5;\n"
+			"\t}\n\n"
+			"\treturn NULL;\n"
+			"}\n\n", prefix, prefix, prefix);
+	}
+
+	/* Strings com caracteres de controle vão para o caminho genérico. */
+	if(gen_has_type(root, RJS_KEY_STRING)){
+		fprintf(out,
+			"static const char *%s_string(const char *p, const char **value, char **cursor, char *end){\n"
+			"\tchar *location = *cursor;\n\n"
+			"\tif(*p != '\\\"')\n"
+			"\t\treturn NULL;\n\n"
+			"\tfor(p++; *p != '\\\"'; p++){\n"
+			"\t\tif(*p == '\\\\' || *p == '\\0' || *cursor == end)\n"
+			"\t\t\treturn NULL;\n\n"
+			"\t\t*(*cursor)++ = *p;\n"
+			"\t}\n\n"
+			"\tif(*cursor == end)\n"
+			"\t\treturn NULL;\n\n"
+			"\t*(*cursor)++ = '\\0';\n"
+			"\t*value = location;\n\n"
+			"\treturn p + 1;\n"
+			"}\n\n", prefix);
+	}
+
+	if(gen_has_type(root, -1)){
+		fprintf(out,
+			"static const char *%s_skip_array(const char *p){\n"
+			"\tint depth = 0;\n"
+			"\tint in_string = 0;\n\n"
+			"\tif(*p != '[')\n"
+			"\t\treturn NULL;\n\n"
+			"\tfor(; *p != '\\0'; p++){\n"
+			"\t\tif(in_string){\n"
+			"\t\t\tif(*p == '\\\\' && p[1] != '\\0')\n"
+			"\t\t\t\tp++;\n"
+			"\t\t\telse if(*p == '\\\"')\n"
+			"\t\t\t\tin_string = 0;\n"
+			"\t\t}\n"
+			"\t\telse if(*p == '\\\"'){\n"
+			"\t\t\tin_string = 1;\n"
+			"\t\t}\n"
+			"\t\telse if(*p == '[' || *p == '{'){\n"
+			"\t\t\tdepth++;\n"
+			"\t\t}\n"
+			"\t\telse if((*p == ']' || *p == '}') && --depth == 0){\n"
+			"\t\t\treturn p + 1;\n"
+			"\t\t}\n"
+			"\t}\n\n"
+			"\treturn NULL;\n"
+			"}\n\n", prefix);
+	}
+}
+
+static int gen_files(const rjs_object_t *root, const char *sample, const char *name){
+	/* O nome, que pode ser um caminho de qualquer tamanho, mais ".h" ou ".c". */
+	char *path = malloc(strlen(name) + 3);
+	char guard[GEN_NAME_SIZE];
+	FILE *header, *source;
+	rjs_size_t i;
+
+	if(path == NULL){
+		fprintf(stderr, "rjs_gen: memória insuficiente\n");
+		return 0;
+	}
+
+	sprintf(path, "%s.h", name);
+	header = fopen(path, "w");
+
+	if(header == NULL){
+		fprintf(stderr, "rjs_gen: não foi possível criar %s\n", path);
+		free(path);
+		return 0;
+	}
+
+	for(i = 0; prefix[i] != '\0'; i++)
+		guard[i] = (prefix[i] >= 'a' && prefix[i] <= 'z') ? (char) (prefix[i] - 'a' + 'A') : prefix[i];
+
+	guard[i] = '\0';
+
+	fprintf(header, "#ifndef %s_H\n#define %s_H\n\n", guard, guard);
+	fprintf(header, "/* Gerado pelo rjs_gen a partir de %s. Não edite. */\n\n", sample);
+	fprintf(header, "#include \"r_json.h\"\n\n");
+	fprintf(header, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+	fprintf(header, "/* Texto de uma array, que pode ser lido com o rjs_parse_string. */\n");
+	fprintf(header, "typedef struct {\n\tconst char *raw;\n\trjs_size_t length;\n} %s_raw_t;\n\n", prefix);
+
+	gen_struct(header, root, prefix);
+
+	fprintf(header,
+		"/* Lê str para out. As strings do caminho rápido são escritas em strings,\n"
+		" * que tem size bytes. Caso o documento não tenha o formato do exemplo, ou\n"
+		" * strings seja pequeno demais, ele é lido com o rjs_parse_string pelo\n"
+		" * parser, e as strings ficam na memória do parser. Chaves que faltam ficam\n"
+		" * com 0 ou NULL. Retorna 1 caso o caminho rápido seja usado, 2 caso o\n"
+		" * genérico seja usado e 0 caso o documento seja inválido. */\n");
+	fprintf(header, "int %s_parse(const char *str, %s_t *out, char *strings, rjs_size_t size, rjs_parser_t *parser);\n\n", prefix, prefix);
+	fprintf(header, "#ifdef __cplusplus\n}\n#endif\n\n#endif\n");
+	fclose(header);
+
+	sprintf(path, "%s.c", name);
+	source = fopen(path, "w");
+
+	if(source == NULL){
+		fprintf(stderr, "rjs_gen: não foi possível criar %s\n", path);
+		free(path);
+		return 0;
+	}
+
+	free(path);
+
+	fprintf(source, "/* Gerado pelo rjs_gen a partir de %s. Não edite. */\n\n", sample);
+	/* O include é resolvido a partir da pasta do .c, onde o .h também está. */
+	fprintf(source, "#include <stddef.h>\n\n#include \"%s.h\"\n\n", strrchr(name, '/') != NULL ? strrchr(name, '/') + 1 : name);
+
+	gen_helpers(source, root);
+	gen_functions(source, root, prefix);
+
+	fprintf(source, "int %s_parse(const char *str, %s_t *out, char *strings, rjs_size_t size, rjs_parser_t *parser){\n", prefix, prefix);
+	fprintf(source,
+		"\tchar *cursor = strings;\n"
+		"\tconst char *end = %s_fast(str, out, &cursor, strings + size);\n"
+		"\tconst rjs_object_t *root;\n\n"
+		"\tif(end != NULL && *%s_skip(end) == '\\0')\n"
+		"\t\treturn 1;\n\n"
+		"\tif(!rjs_parse_string(parser, str))\n"
+		"\t\treturn 0;\n\n"
+		"\troot = rjs_get_main_object(parser);\n"
+		"\t%s_generic(root, out, str, root->offset);\n\n"
+		"\treturn 2;\n"
+		"}\n", prefix, prefix, prefix);
+
+	fclose(source);
+
+	return 1;
+}
+
+int main(int argc, char **argv){
+	FILE *file;
+	char *text, *memory;
+	long size;
+	rjs_parser_t parser;
+	const char *name;
+	int success;
+
+	if(argc != 3){
+		fprintf(stderr, "Uso: rjs_gen <exemplo.json> <nome>\n");
+		return 1;
+	}
+
+	file = fopen(argv[1], "rb");
+
+	if(file == NULL){
+		fprintf(stderr, "rjs_gen: não foi possível abrir %s\n", argv[1]);
+		return 1;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	text = malloc((size_t) size + 1);
+	memory = malloc((size_t) size * 16 + 65536);
+
+	if(text == NULL || memory == NULL || fread(text, 1, (size_t) size, file) != (size_t) size){
+		fprintf(stderr, "rjs_gen: não foi possível ler %s\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+
+	text[size] = '\0';
+	fclose(file);
+
+	rjs_create_parser(&parser, memory, (rjs_size_t) size * 16 + 65536);
+
+	if(!rjs_parse_string(&parser, text)){
+		fprintf(stderr, "rjs_gen: %s: %s\n", argv[1], rjs_get_error(&parser));
+		return 1;
+	}
+
+	/* O nome pode ser um caminho; o prefixo usa só o nome do arquivo. */
+	name = strrchr(argv[2], '/') != NULL ? strrchr(argv[2], '/') + 1 : argv[2];
+	gen_identifier(prefix, name);
+
+	success = gen_files(rjs_get_main_object(&parser), argv[1], argv[2]);
+
+	free(memory);
+	free(text);
+
+	return success ? 0 : 1;
+}